@@ -14,6 +14,7 @@
 #ifdef ENABLE_VECTO
 
 #define AVX_VEC_SIZE_CHAR 32
+#define AVX_VEC_SIZE_SHORT 16
 #define AVX_VEC_SIZE_INT 8
 #define AVX_VEC_SIZE_FLOAT 8
 #define AVX_VEC_SIZE_DOUBLE 4
@@ -21,6 +22,7 @@
 #define AVX_WIDTH AVX_VEC_SIZE_CHAR
 
 #define AVX512_VEC_SIZE_CHAR 64
+#define AVX512_VEC_SIZE_SHORT 32
 #define AVX512_VEC_SIZE_INT 16
 #define AVX512_VEC_SIZE_FLOAT 16
 #define AVX512_VEC_SIZE_DOUBLE 8
@@ -28,6 +30,7 @@
 #define AVX512_WIDTH AVX512_VEC_SIZE_CHAR
 
 #define SSE_VEC_SIZE_CHAR 16
+#define SSE_VEC_SIZE_SHORT 8
 #define SSE_VEC_SIZE_INT 4
 #define SSE_VEC_SIZE_FLOAT 4
 #define SSE_VEC_SIZE_DOUBLE 2
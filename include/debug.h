@@ -16,6 +16,8 @@
 //      'i' -- initialization sequence
 //      'u' -- user
 //      'M' -- MPI
+//      'n' -- NUMA placement
+//      'a' -- memory allocation (huge pages)
 
 #include "global.h"
 #include "api_funcs.h"
@@ -13,6 +13,8 @@
 #include "ocl.h"
 #include "pthread_barrier.h"
 #include "scheduler.h"
+#include "team.h"
+#include "vec_aligned_alloc.h"
 #include "minmax.h"
 
 #ifdef ENABLE_MPI
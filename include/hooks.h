@@ -22,6 +22,13 @@ void hooks_establish_bindings (int silent);
 void hooks_draw_helper (char *suffix, void_func_t default_func);
 
 // Call appropriate do_tile_${suffix} function, with calls to monitoring start/end
+// When the tiling flavor provides a pair of do_tile_${suffix}_inner and
+// do_tile_${suffix}_border functions, tiles which do not touch the image border
+// are given to the inner one
 int do_tile (int x, int y, int width, int height, int who);
 
+// Call do_tile on the t-th tile (0 <= t < NB_TILES_X * NB_TILES_Y), tiles
+// touching the image border being numbered first
+int do_tile_border_first (unsigned t, int who);
+
 #endif
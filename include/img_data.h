@@ -3,6 +3,7 @@
 
 #include "global.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 extern uint32_t *restrict image, *restrict alt_image;
@@ -27,6 +28,11 @@ void img_data_alloc (void);
 void img_data_free (void);
 void img_data_replicate (void);
 
+// Registers a DIM x DIM array (e.g. a kernel table) which is placed like the
+// images by the generic first-touch. Must be called by the init hook.
+void img_data_register_table (char *name, void *ptr, size_t elem_size);
+void img_data_first_touch (void);
+
 // Useful color functions
 
 static inline int extract_red (uint32_t c)
@@ -12,6 +12,14 @@ static inline void monitoring_declare_task_ids (char *task_ids[])
   trace_record_declare_task_ids (task_ids);
 }
 
+// Per-iteration value (e.g. amount of active data) stored in the trace.
+// Values recorded during the same iteration are added up, and easyview
+// displays the sum when hovering the iteration.
+static inline void monitoring_counter (unsigned value)
+{
+  trace_record_counter (value);
+}
+
 #ifdef ENABLE_SDL
 
 static inline long monitoring_start_iteration (void)
@@ -150,6 +158,7 @@ static inline void monitoring_gpu_tile (unsigned x, unsigned y, unsigned w,
 #define monitoring_end_tile(x, y, w, h, c) (void)0
 #define monitoring_end_tile_id(x, y, w, h, c, id) (void)0
 #define monitoring_gpu_tile(x, y, w, h, c, s, e, tt) (void)0
+#define monitoring_counter(v) (void)0
 
 #endif
 
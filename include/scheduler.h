@@ -1,6 +1,7 @@
 #ifndef SCHEDULER_IS_DEF
 #define SCHEDULER_IS_DEF
 
+#include <hwloc.h>
 
 typedef void (*task_func_t)(void *, unsigned);
 
@@ -10,5 +11,20 @@ void scheduler_finalize (void);
 void scheduler_task_wait (void);
 void scheduler_create_task (task_func_t task, void *param, unsigned cpu);
 
+// Tasks with dependencies: the task is started once all its predecessors
+// (NULL handles are ignored) have completed. Handles remain valid until the
+// next call to scheduler_task_wait.
+typedef struct task_handle *task_handle_t;
+
+task_handle_t scheduler_create_task_dep (task_func_t task, void *param,
+                                         unsigned cpu, task_handle_t deps[],
+                                         unsigned nb_deps);
+
+// The hwloc topology is loaded once and shared with the thread team. Each
+// call to scheduler_get_topology must be matched by a call to
+// scheduler_release_topology.
+hwloc_topology_t scheduler_get_topology (void);
+void scheduler_release_topology (void);
+
 
 #endif
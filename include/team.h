@@ -0,0 +1,28 @@
+#ifndef TEAM_IS_DEF
+#define TEAM_IS_DEF
+
+// Persistent team of threads, spawned by the first team_run call (or
+// explicitly with team_init) and joined at exit. The master thread is member
+// 0. Between jobs, helper threads spin for a while, then sleep.
+
+typedef void (*team_func_t) (unsigned me, void *arg);
+
+unsigned team_init (unsigned nb_threads);
+void team_finalize (void);
+
+unsigned team_size (void);
+
+// Every member of the team (including the caller, as member 0) runs f (me,
+// arg). Returns when all members are done.
+void team_run (team_func_t f, void *arg);
+
+// Sense-reversing spin barrier. Must be called by every member of the team.
+void team_barrier (unsigned me);
+
+// Calls do_tile on every tile of the image, distributed among team members
+// according to OMP_SCHEDULE (static blocks by default, "dynamic" and "guided"
+// use a shared counter), then joins the barrier. Returns the logical OR of
+// all do_tile results, for all members.
+int team_for_tiles (unsigned me);
+
+#endif
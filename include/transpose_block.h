@@ -0,0 +1,125 @@
+#ifndef TRANSPOSE_BLOCK_IS_DEF
+#define TRANSPOSE_BLOCK_IS_DEF
+
+#include <stdint.h>
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+#include <immintrin.h>
+#endif
+
+// Block transposition helpers shared by the transpose and rotation90 kernels.
+// All of them compute dst[a * dst_stride + b] = src[b * src_stride + a] for
+// 0 <= a < height and 0 <= b < width. A negative dst_stride (with dst pointing
+// to the last row) reverses the order of destination rows, which turns a
+// transposition into a rotation.
+
+#define TRANSPOSE_BLOCK 8
+#define TRANSPOSE_LEAF 32 // Recursion stops below TRANSPOSE_LEAF^2 pixels
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+
+// 8x8 block transposed within registers
+static inline void transpose_8x8 (uint32_t *restrict dst, int dst_stride,
+                                  uint32_t *restrict src, int src_stride)
+{
+  __m256i r0 = _mm256_loadu_si256 ((__m256i *)(src + 0 * src_stride));
+  __m256i r1 = _mm256_loadu_si256 ((__m256i *)(src + 1 * src_stride));
+  __m256i r2 = _mm256_loadu_si256 ((__m256i *)(src + 2 * src_stride));
+  __m256i r3 = _mm256_loadu_si256 ((__m256i *)(src + 3 * src_stride));
+  __m256i r4 = _mm256_loadu_si256 ((__m256i *)(src + 4 * src_stride));
+  __m256i r5 = _mm256_loadu_si256 ((__m256i *)(src + 5 * src_stride));
+  __m256i r6 = _mm256_loadu_si256 ((__m256i *)(src + 6 * src_stride));
+  __m256i r7 = _mm256_loadu_si256 ((__m256i *)(src + 7 * src_stride));
+
+  // Interleave 32-bit elements of row pairs
+  __m256i t0 = _mm256_unpacklo_epi32 (r0, r1);
+  __m256i t1 = _mm256_unpackhi_epi32 (r0, r1);
+  __m256i t2 = _mm256_unpacklo_epi32 (r2, r3);
+  __m256i t3 = _mm256_unpackhi_epi32 (r2, r3);
+  __m256i t4 = _mm256_unpacklo_epi32 (r4, r5);
+  __m256i t5 = _mm256_unpackhi_epi32 (r4, r5);
+  __m256i t6 = _mm256_unpacklo_epi32 (r6, r7);
+  __m256i t7 = _mm256_unpackhi_epi32 (r6, r7);
+
+  // Interleave 64-bit pairs: each 128-bit lane now holds 4 rows of a column
+  __m256i u0 = _mm256_unpacklo_epi64 (t0, t2);
+  __m256i u1 = _mm256_unpackhi_epi64 (t0, t2);
+  __m256i u2 = _mm256_unpacklo_epi64 (t1, t3);
+  __m256i u3 = _mm256_unpackhi_epi64 (t1, t3);
+  __m256i u4 = _mm256_unpacklo_epi64 (t4, t6);
+  __m256i u5 = _mm256_unpackhi_epi64 (t4, t6);
+  __m256i u6 = _mm256_unpacklo_epi64 (t5, t7);
+  __m256i u7 = _mm256_unpackhi_epi64 (t5, t7);
+
+  // Gather the 128-bit lanes of rows 0-3 and 4-7
+  _mm256_storeu_si256 ((__m256i *)(dst + 0 * dst_stride),
+                       _mm256_permute2x128_si256 (u0, u4, 0x20));
+  _mm256_storeu_si256 ((__m256i *)(dst + 1 * dst_stride),
+                       _mm256_permute2x128_si256 (u1, u5, 0x20));
+  _mm256_storeu_si256 ((__m256i *)(dst + 2 * dst_stride),
+                       _mm256_permute2x128_si256 (u2, u6, 0x20));
+  _mm256_storeu_si256 ((__m256i *)(dst + 3 * dst_stride),
+                       _mm256_permute2x128_si256 (u3, u7, 0x20));
+  _mm256_storeu_si256 ((__m256i *)(dst + 4 * dst_stride),
+                       _mm256_permute2x128_si256 (u0, u4, 0x31));
+  _mm256_storeu_si256 ((__m256i *)(dst + 5 * dst_stride),
+                       _mm256_permute2x128_si256 (u1, u5, 0x31));
+  _mm256_storeu_si256 ((__m256i *)(dst + 6 * dst_stride),
+                       _mm256_permute2x128_si256 (u2, u6, 0x31));
+  _mm256_storeu_si256 ((__m256i *)(dst + 7 * dst_stride),
+                       _mm256_permute2x128_si256 (u3, u7, 0x31));
+}
+
+#endif
+
+// Transposition of a width x height block, using the 8x8 micro-kernel on
+// full blocks when available
+static inline void transpose_block (uint32_t *restrict dst, int dst_stride,
+                                    uint32_t *restrict src, int src_stride,
+                                    int width, int height)
+{
+  int a0 = 0, b0 = 0;
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+  for (a0 = 0; a0 + TRANSPOSE_BLOCK <= height; a0 += TRANSPOSE_BLOCK)
+    for (b0 = 0; b0 + TRANSPOSE_BLOCK <= width; b0 += TRANSPOSE_BLOCK)
+      transpose_8x8 (dst + a0 * dst_stride + b0, dst_stride,
+                     src + b0 * src_stride + a0, src_stride);
+
+  // Right remainder of the full rows
+  for (int a = 0; a < a0; a++)
+    for (int b = b0; b < width; b++)
+      dst[a * dst_stride + b] = src[b * src_stride + a];
+#endif
+
+  // Bottom remainder
+  for (int a = a0; a < height; a++)
+    for (int b = 0; b < width; b++)
+      dst[a * dst_stride + b] = src[b * src_stride + a];
+}
+
+// Cache-oblivious transposition: the largest dimension is split in halves
+// until blocks fit in the cache whatever its size
+static inline void transpose_rec (uint32_t *restrict dst, int dst_stride,
+                                  uint32_t *restrict src, int src_stride,
+                                  int width, int height)
+{
+  if (width * height <= TRANSPOSE_LEAF * TRANSPOSE_LEAF)
+    transpose_block (dst, dst_stride, src, src_stride, width, height);
+  else if (width >= height) {
+    // Keep halves multiple of the micro-kernel size
+    const int w = (width / 2 + TRANSPOSE_BLOCK - 1) & ~(TRANSPOSE_BLOCK - 1);
+
+    transpose_rec (dst, dst_stride, src, src_stride, w, height);
+    transpose_rec (dst + w, dst_stride, src + w * src_stride, src_stride,
+                   width - w, height);
+  } else {
+    const int h = (height / 2 + TRANSPOSE_BLOCK - 1) & ~(TRANSPOSE_BLOCK - 1);
+
+    transpose_rec (dst, dst_stride, src, src_stride, width, h);
+    transpose_rec (dst + h * dst_stride, dst_stride, src + h, src_stride,
+                   width, height - h);
+  }
+}
+
+#endif
@@ -7,4 +7,12 @@ void *vec_aligned_malloc (size_t size);
 
 void vec_aligned_free (void *p);
 
+// Zero-filled, page-aligned allocation of large tables and images. Huge pages
+// (2 MB) are requested when size is large enough, either explicitly
+// (MAP_HUGETLB) or through transparent huge pages. Returns NULL on failure.
+void *vec_huge_malloc (size_t size);
+
+// size must be the one given to vec_huge_malloc
+void vec_huge_free (void *p, size_t size);
+
 #endif
@@ -2,12 +2,249 @@
 #include "easypap.h"
 
 #include <omp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
-///////////////////////////// Sequential version (tiled)
+// Window sums of the separable engine are 32-bit signed integers:
+// 255 * (2 * BLUR_MAX_RADIUS + 1)^2 must stay below 2^31
+#define BLUR_MAX_RADIUS 1024
+
+static int radius = 1;
+
+// The parameter is used to fix the radius of the blur (default 1). Only the
+// separable engine (default tiling) and the OpenCL kernel support larger
+// radii.
+void blur_config (char *param)
+{
+  if (param != NULL) {
+    char *end;
+    long r = strtol (param, &end, 10);
+
+    if (end == param || *end != '\0' || r <= 0 || r >= DIM ||
+        r > BLUR_MAX_RADIUS)
+      exit_with_error ("Blur radius must be in [1, %d] (%s)",
+                       min (DIM - 1, BLUR_MAX_RADIUS), param);
+    radius = r;
+  }
+
+  if (radius > 1 && !opencl_used &&
+      (strcmp (tile_name, "default") ||
+       !strcmp (variant_name, "omp_tiled_temporal")))
+    exit_with_error ("Blur radius %d is only supported by the default tiling "
+                     "(and not by the omp_tiled_temporal variant)",
+                     radius);
+}
+
+///////////////////////////// Separable engine (default tiling)
 // Suggested cmdline(s):
-// ./run -l images/1024.png -k blur -v seq -si
+// ./run -l images/1024.png -k blur -v seq -a 8
+//
+// The box filter of radius r is computed as a horizontal pass followed by a
+// vertical pass, both using running sums: the cost per pixel does not depend
+// on r. As in blur_do_tile_naive, windows are clipped at image borders and
+// each channel gets the truncated mean of the pixels of the window. Rows
+// entering and leaving the vertical window are summed horizontally on the
+// fly, so each thread only needs a scratch buffer of a few rows, allocated
+// once by blur_init.
 //
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+#include <immintrin.h>
+
+// The four channels of a pixel, one per 32-bit lane
+typedef __m128i blur_sum_t;
+
+static inline blur_sum_t blur_unpack (uint32_t c)
+{
+  return _mm_cvtepu8_epi32 (_mm_cvtsi32_si128 (c));
+}
+
+static inline blur_sum_t blur_zero (void)
+{
+  return _mm_setzero_si128 ();
+}
+
+static inline blur_sum_t blur_add (blur_sum_t a, blur_sum_t b)
+{
+  return _mm_add_epi32 (a, b);
+}
+
+static inline blur_sum_t blur_sub (blur_sum_t a, blur_sum_t b)
+{
+  return _mm_sub_epi32 (a, b);
+}
+
+// Multiplying by the reciprocal of the pixel count in double precision gives
+// the same result as an integer division (the 0.5 offset keeps exact
+// multiples away from rounding errors)
+static inline uint32_t blur_pack (blur_sum_t sum, double rcp)
+{
+  __m256d v = _mm256_add_pd (_mm256_cvtepi32_pd (sum), _mm256_set1_pd (0.5));
+  __m128i c = _mm256_cvttpd_epi32 (_mm256_mul_pd (v, _mm256_set1_pd (rcp)));
+
+  c = _mm_packus_epi32 (c, c);
+  c = _mm_packus_epi16 (c, c);
+
+  return _mm_cvtsi128_si32 (c);
+}
+
+#else
+
+// Channel k of the sum is the sum of the bytes k of the pixels
+typedef struct
+{
+  int32_t c[4];
+} blur_sum_t;
+
+static inline blur_sum_t blur_unpack (uint32_t c)
+{
+  return (blur_sum_t){{c & 255, (c >> 8) & 255, (c >> 16) & 255, c >> 24}};
+}
+
+static inline blur_sum_t blur_zero (void)
+{
+  return (blur_sum_t){{0, 0, 0, 0}};
+}
+
+static inline blur_sum_t blur_add (blur_sum_t a, blur_sum_t b)
+{
+  for (int k = 0; k < 4; k++)
+    a.c[k] += b.c[k];
+  return a;
+}
+
+static inline blur_sum_t blur_sub (blur_sum_t a, blur_sum_t b)
+{
+  for (int k = 0; k < 4; k++)
+    a.c[k] -= b.c[k];
+  return a;
+}
+
+static inline uint32_t blur_pack (blur_sum_t sum, double rcp)
+{
+  uint32_t c = 0;
+
+  for (int k = 0; k < 4; k++)
+    c |= (uint32_t)((sum.c[k] + 0.5) * rcp) << (8 * k);
+
+  return c;
+}
+
+#endif
+
+// Each thread (OpenMP, scheduler or team worker) gets its own slot of the
+// scratch area the first time it computes a tile
+static char *scratch       = NULL;
+static size_t scratch_size = 0;
+static unsigned scratch_slots;
+static unsigned next_slot          = 0;
+static __thread int my_scratch_slot = -1;
+
+void blur_init (void)
+{
+  if (scratch != NULL)
+    return;
+
+  // Vertical sums, horizontal sums of one row and reciprocals of the column
+  // window sizes, rounded up to a cache line
+  scratch_size =
+      (2 * DIM * sizeof (blur_sum_t) + DIM * sizeof (double) + 63) & ~63UL;
+  // The master thread may compute tiles too
+  scratch_slots = easypap_requested_number_of_threads () + 1;
+  scratch       = vec_aligned_malloc (scratch_slots * scratch_size);
+  if (scratch == NULL)
+    exit_with_error ("Cannot allocate blur scratch buffers");
+}
+
+void blur_finalize (void)
+{
+  vec_aligned_free (scratch);
+  scratch = NULL;
+}
+
+static inline char *blur_scratch (void)
+{
+  if (my_scratch_slot < 0) {
+    my_scratch_slot = __atomic_fetch_add (&next_slot, 1, __ATOMIC_RELAXED);
+    if (my_scratch_slot >= scratch_slots)
+      exit_with_error ("Too many threads for blur scratch buffers (%d)",
+                       scratch_slots);
+  }
+
+  return scratch + my_scratch_slot * scratch_size;
+}
+
+// Number of pixels of the window centered on row (or column) i
+static inline int blur_window (int i)
+{
+  return min (i + radius, DIM - 1) - max (i - radius, 0) + 1;
+}
+
+// Horizontal window sums of the pixels (i, x) to (i, x + width - 1)
+static void blur_hrow (blur_sum_t *restrict h, int i, int x, int width)
+{
+  blur_sum_t s = blur_zero ();
+
+  for (int j = max (x - radius, 0); j <= min (x + radius, DIM - 1); j++)
+    s = blur_add (s, blur_unpack (cur_img (i, j)));
+  h[0] = s;
+
+  for (int j = x + 1; j < x + width; j++) {
+    if (j + radius < DIM)
+      s = blur_add (s, blur_unpack (cur_img (i, j + radius)));
+    if (j - radius > 0)
+      s = blur_sub (s, blur_unpack (cur_img (i, j - radius - 1)));
+    h[j - x] = s;
+  }
+}
+
 int blur_do_tile_default (int x, int y, int width, int height)
+{
+  char *buffer           = blur_scratch ();
+  blur_sum_t *restrict v = (blur_sum_t *)buffer;
+  blur_sum_t *restrict h = v + DIM;
+  double *restrict rcp   = (double *)(h + DIM);
+
+  for (int j = 0; j < width; j++) {
+    rcp[j] = 1.0 / blur_window (x + j);
+    v[j]   = blur_zero ();
+  }
+
+  // Vertical window of the first row of the tile
+  for (int i = max (y - radius, 0); i <= min (y + radius, DIM - 1); i++) {
+    blur_hrow (h, i, x, width);
+    for (int j = 0; j < width; j++)
+      v[j] = blur_add (v[j], h[j]);
+  }
+
+  for (int i = y; i < y + height; i++) {
+    if (i > y) {
+      if (i + radius < DIM) {
+        blur_hrow (h, i + radius, x, width);
+        for (int j = 0; j < width; j++)
+          v[j] = blur_add (v[j], h[j]);
+      }
+      if (i - radius > 0) {
+        blur_hrow (h, i - radius - 1, x, width);
+        for (int j = 0; j < width; j++)
+          v[j] = blur_sub (v[j], h[j]);
+      }
+    }
+
+    const double rcp_y = 1.0 / blur_window (i);
+
+    for (int j = 0; j < width; j++)
+      next_img (i, x + j) = blur_pack (v[j], rcp[j] * rcp_y);
+  }
+
+  return 0;
+}
+
+///////////////////////////// Naive 3x3 version (-wt naive)
+// Suggested cmdline(s):
+// ./run -l images/1024.png -k blur -v seq -wt naive -si
+//
+int blur_do_tile_naive (int x, int y, int width, int height)
 {
   for (int i = y; i < y + height; i++)
     for (int j = x; j < x + width; j++) {
@@ -39,15 +276,14 @@ int blur_do_tile_default (int x, int y, int width, int height)
   return 0;
 }
 
-///////////////////////////// Sequential version (tiled)
+///////////////////////////// Inner/border tiling (opt)
 // Suggested cmdline(s):
-// ./run -l images/1024.png -k blur -v seq -si
+// ./run -l images/1024.png -k blur -v tiled -wt opt -ts 32
 //
-int blur_do_tile_opt (int x, int y, int width, int height)
+// Inner tiles do not touch the image border: neighbours are read without
+// any check
+int blur_do_tile_opt_inner (int x, int y, int width, int height)
 {
-  if (x == 0 || x == DIM - width || y == 0 || y == DIM - height)
-    return blur_do_tile_default(x, y, width, height);
-  
   for (int i = y; i < y + height; i++)
     for (int j = x; j < x + width; j++) {
       unsigned r = 0, g = 0, b = 0, a = 0, n = 0;
@@ -78,6 +314,11 @@ int blur_do_tile_opt (int x, int y, int width, int height)
   return 0;
 }
 
+int blur_do_tile_opt_border (int x, int y, int width, int height)
+{
+  return blur_do_tile_naive (x, y, width, height);
+}
+
 ///////////////////////////// Sequential version (seq)
 // Suggested cmdline(s):
 // ./run -l images/1024.png -k blur -v seq
@@ -112,34 +353,226 @@ unsigned blur_compute_tiled (unsigned nb_iter)
   return 0;
 }
 
-///////////////////////////// Border parallel version (omp)
+///////////////////////////// Tiled parallel version (omp_tiled)
 // Suggested cmdline(s):
-// ./run -l images/1024.png -k blur -v tiled -ts 32 -m si
+// ./run -l images/1024.png -k blur -v omp_tiled -ts 32 -a 4 -m
 //
+unsigned blur_compute_omp_tiled (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    #pragma omp parallel for schedule(runtime) collapse(2)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        do_tile (x, y, TILE_W, TILE_H, omp_get_thread_num ());
+
+    swap_images ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Border first parallel version (omp)
+// Suggested cmdline(s):
+// ./run -l images/1024.png -k blur -v omp -wt opt -ts 32 -m
+//
+// Border tiles, which are slower, are distributed first
 unsigned blur_compute_omp (unsigned nb_iter)
 {
-  #pragma omp parallel
   for (unsigned it = 1; it <= nb_iter; it++) {
 
-    #pragma omp for nowait schedule(dynamic)
-    for (int k = 0; k < DIM; k += TILE_W) {
-      do_tile (k, 0, TILE_W, TILE_H, omp_get_thread_num());
-      do_tile (k, DIM-TILE_H, TILE_W, TILE_H, omp_get_thread_num());
-    }
+    #pragma omp parallel for schedule(dynamic)
+    for (unsigned t = 0; t < NB_TILES_X * NB_TILES_Y; t++)
+      do_tile_border_first (t, omp_get_thread_num ());
 
-    #pragma omp for nowait schedule(dynamic)
-    for (int k = 0; k < DIM; k += TILE_H) {
-      do_tile (0, k, TILE_W, TILE_H, omp_get_thread_num());
-      do_tile (DIM-TILE_W, k, TILE_W, TILE_H, omp_get_thread_num());
-    }
+    swap_images ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Work-stealing scheduler version (sched)
+// Suggested cmdline(s):
+// ./run -l images/1024.png -k blur -v sched -ts 16 -m
+//
+void blur_init_sched (void)
+{
+  blur_init ();
+
+  scheduler_init (-1);
+}
+
+void blur_finalize_sched (void)
+{
+  scheduler_finalize ();
 
-    #pragma omp for schedule(dynamic) collapse(2)
-    for (int y = TILE_H; y < DIM-TILE_H; y += TILE_H)
-      for (int x = TILE_W; x < DIM-TILE_W; x += TILE_W)
-        do_tile (x, y, TILE_W, TILE_H, omp_get_thread_num());
+  blur_finalize ();
+}
+
+static void blur_tile_task (void *p, unsigned cpu)
+{
+  const unsigned tile = (uintptr_t)p;
+  const int x         = (tile % (DIM / TILE_W)) * TILE_W;
+  const int y         = (tile / (DIM / TILE_W)) * TILE_H;
+
+  do_tile (x, y, TILE_W, TILE_H, cpu);
+}
+
+unsigned blur_compute_sched (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    for (uintptr_t tile = 0; tile < (DIM / TILE_W) * (DIM / TILE_H); tile++)
+      scheduler_create_task (blur_tile_task, (void *)tile, -1);
+
+    scheduler_task_wait ();
 
     swap_images ();
   }
 
   return 0;
-}
\ No newline at end of file
+}
+
+///////////////////////////// Temporal blocking version (omp_tiled_temporal)
+// Suggested cmdline(s):
+// TEMPORAL_DEPTH=8 ./run -l images/1024.png -k blur -v omp_tiled_temporal -ts 64 -m
+//
+// Each tile is loaded along with a halo of depth k into a private buffer and
+// blurred k times in cache before being written back (overlapped tiling: the
+// halo shrinks by one pixel at each step). k is set with the TEMPORAL_DEPTH
+// environment variable (default 4).
+//
+static unsigned temporal_depth = 4;
+
+void blur_init_omp_tiled_temporal (void)
+{
+  char *str = getenv ("TEMPORAL_DEPTH");
+
+  blur_init ();
+
+  if (str != NULL) {
+    temporal_depth = atoi (str);
+    if (temporal_depth == 0)
+      exit_with_error ("TEMPORAL_DEPTH must be a positive integer (%s)", str);
+  }
+
+  PRINT_DEBUG ('u', "Temporal blocking depth: %u\n", temporal_depth);
+}
+
+static void blur_temporal_tile (int x, int y, unsigned depth,
+                                unsigned *restrict a, unsigned *restrict b)
+{
+  const int k = depth, H = TILE_H + 2 * k, W = TILE_W + 2 * k;
+  const int y0 = y - k, x0 = x - k;
+  unsigned *restrict src = a, *restrict dst = b;
+
+  // Pixels lying outside of the image are never accessed
+  for (int i = max (y0, 0); i < min (y0 + H, DIM); i++)
+    for (int j = max (x0, 0); j < min (x0 + W, DIM); j++)
+      src[(i - y0) * W + (j - x0)] = cur_img (i, j);
+
+  for (int s = 1; s <= k; s++) {
+    // Only pixels which are at least s pixels away from the buffer edges are
+    // valid at step s
+    const int i_start = max (y0 + s, 0), i_end = min (y0 + H - s, DIM);
+    const int j_start = max (x0 + s, 0), j_end = min (x0 + W - s, DIM);
+
+    for (int i = i_start; i < i_end; i++)
+      for (int j = j_start; j < j_end; j++) {
+        unsigned r = 0, g = 0, b = 0, a = 0, n = 0;
+
+        int i_d = (i > 0) ? i - 1 : i;
+        int i_f = (i < DIM - 1) ? i + 1 : i;
+        int j_d = (j > 0) ? j - 1 : j;
+        int j_f = (j < DIM - 1) ? j + 1 : j;
+
+        for (int yloc = i_d; yloc <= i_f; yloc++)
+          for (int xloc = j_d; xloc <= j_f; xloc++) {
+            unsigned c = src[(yloc - y0) * W + (xloc - x0)];
+            r += extract_red (c);
+            g += extract_green (c);
+            b += extract_blue (c);
+            a += extract_alpha (c);
+            n += 1;
+          }
+
+        r /= n;
+        g /= n;
+        b /= n;
+        a /= n;
+
+        dst[(i - y0) * W + (j - x0)] = rgba (r, g, b, a);
+      }
+
+    unsigned *tmp = src;
+    src           = dst;
+    dst           = tmp;
+  }
+
+  for (int i = y; i < y + TILE_H; i++)
+    for (int j = x; j < x + TILE_W; j++)
+      next_img (i, j) = src[(i - y0) * W + (j - x0)];
+}
+
+unsigned blur_compute_omp_tiled_temporal (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it += temporal_depth) {
+    const unsigned depth = min (temporal_depth, nb_iter - it + 1);
+    const unsigned size  = (TILE_H + 2 * depth) * (TILE_W + 2 * depth);
+
+    #pragma omp parallel
+    {
+      unsigned *buffer = malloc (2 * size * sizeof (unsigned));
+
+      #pragma omp for schedule(runtime) collapse(2)
+      for (int y = 0; y < DIM; y += TILE_H)
+        for (int x = 0; x < DIM; x += TILE_W) {
+          monitoring_start_tile (omp_get_thread_num ());
+
+          blur_temporal_tile (x, y, depth, buffer, buffer + size);
+
+          monitoring_end_tile (x, y, TILE_W, TILE_H, omp_get_thread_num ());
+        }
+
+      free (buffer);
+    }
+
+    swap_images ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// Persistent thread team version (team)
+// Suggested cmdline(s):
+// ./run -l images/1024.png -k blur -v team -ts 32 -i 1000 -n
+//
+void blur_init_team (void)
+{
+  blur_init ();
+
+  team_init (easypap_requested_number_of_threads ());
+}
+
+static void blur_team_body (unsigned me, void *arg)
+{
+  const unsigned nb_iter = *(unsigned *)arg;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    team_for_tiles (me);
+
+    if (me == 0)
+      swap_images ();
+
+    team_barrier (me);
+  }
+}
+
+unsigned blur_compute_team (unsigned nb_iter)
+{
+  team_run (blur_team_body, &nb_iter);
+
+  return 0;
+}
+
@@ -4,8 +4,8 @@
 
 #include <omp.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
-#include <sys/mman.h>
 #include <unistd.h>
 
 #include <assert.h>
@@ -29,28 +29,61 @@ static inline cell_t *table_cell (cell_t *restrict i, int y, int x)
 #define last_changed_table(y, x) (_last_changed[(y) * (DIM / TILE_H) + (x)])
 #define next_changed_table(y, x) (_next_changed[(y) * (DIM / TILE_H) + (x)])
 
+// Bit-packed representation: each row is made of DIM / 64 words, and cell
+// (y, x) is stored in bit (x % 64) of word (x / 64). This representation is
+// used instead of the classic one when the "bitpacked" tiling is selected
+// (-wt bitpacked or EASYPAP_TILEPREF=bitpacked).
+typedef uint64_t word_t;
+
+#define WORD_BITS 64
+
+static word_t *restrict _packed_table = NULL,
+              *restrict _packed_alternate_table = NULL;
+static bool bitpacked = false;
+
+#define WORDS_PER_ROW (DIM / WORD_BITS)
+
+static inline word_t *packed_row (word_t *restrict t, int y)
+{
+  return t + y * WORDS_PER_ROW;
+}
+
+#define cur_packed_row(y) packed_row (_packed_table, (y))
+#define next_packed_row(y) packed_row (_packed_alternate_table, (y))
+
 void life_init (void)
 {
   // life_init may be (indirectly) called several times so we check if data were
   // already allocated
-  if (_table == NULL) {
+  if (_table == NULL && _packed_table == NULL) {
     const unsigned size = DIM * DIM * sizeof (cell_t);
+    const unsigned packed_size = DIM * WORDS_PER_ROW * sizeof (word_t);
     const unsigned changed_size = (DIM / TILE_H) * (DIM / TILE_W) * sizeof(unsigned);
 
-    PRINT_DEBUG ('u', "Memory footprint = 2 x %d bytes (classic) + %d bytes (lazy)\n", size, changed_size);
+    bitpacked = !opencl_used && !strcmp (tile_name, "bitpacked");
+
+    if (bitpacked) {
+      PRINT_DEBUG ('u', "Memory footprint = 2 x %d bytes (bitpacked) + %d bytes (lazy)\n", packed_size, changed_size);
+
+      _packed_table = vec_huge_malloc (packed_size);
 
-    _table = mmap (NULL, size, PROT_READ | PROT_WRITE,
-                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      _packed_alternate_table = vec_huge_malloc (packed_size);
+    } else {
+      PRINT_DEBUG ('u', "Memory footprint = 2 x %d bytes (classic) + %d bytes (lazy)\n", size, changed_size);
 
-    _alternate_table = mmap (NULL, size, PROT_READ | PROT_WRITE,
-                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      _table = vec_huge_malloc (size);
+
+      _alternate_table = vec_huge_malloc (size);
+
+      img_data_register_table ("table", _table, sizeof (cell_t));
+      img_data_register_table ("alternate_table", _alternate_table,
+                               sizeof (cell_t));
+    }
 
 
-    _last_changed = mmap (NULL, changed_size, PROT_READ | PROT_WRITE,
-                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    _last_changed = vec_huge_malloc (changed_size);
 
-    _next_changed = mmap (NULL, changed_size, PROT_READ | PROT_WRITE,
-                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    _next_changed = vec_huge_malloc (changed_size);
 
     for (unsigned i = 0; i < (changed_size / sizeof(unsigned)); ++i) {
       _last_changed[i] = 1;
@@ -62,17 +95,32 @@ void life_init (void)
 void life_finalize (void)
 {
   const unsigned size = DIM * DIM * sizeof (cell_t);
+  const unsigned packed_size = DIM * WORDS_PER_ROW * sizeof (word_t);
   const unsigned changed_size = (DIM / TILE_H) * (DIM / TILE_W) * sizeof(unsigned);
 
-  munmap (_table, size);
-  munmap (_alternate_table, size);
-  munmap (_last_changed, changed_size);
-  munmap (_next_changed, changed_size);
+  if (bitpacked) {
+    vec_huge_free (_packed_table, packed_size);
+    vec_huge_free (_packed_alternate_table, packed_size);
+  } else {
+    vec_huge_free (_table, size);
+    vec_huge_free (_alternate_table, size);
+  }
+  vec_huge_free (_last_changed, changed_size);
+  vec_huge_free (_next_changed, changed_size);
 }
 
 // This function is called whenever the graphical window needs to be refreshed
 void life_refresh_img (void)
 {
+  if (bitpacked) {
+    for (int i = 0; i < DIM; i++) {
+      word_t *row = cur_packed_row (i);
+      for (int j = 0; j < DIM; j++)
+        cur_img (i, j) = ((row[j / WORD_BITS] >> (j % WORD_BITS)) & 1) * color;
+    }
+    return;
+  }
+
   for (int i = 0; i < DIM; i++)
     for (int j = 0; j < DIM; j++)
       cur_img (i, j) = cur_table (i, j) * color;
@@ -170,6 +218,11 @@ static inline void swap_tables (void)
   _table           = _alternate_table;
   _alternate_table = tmp;
 
+  word_t *ptmp = _packed_table;
+
+  _packed_table           = _packed_alternate_table;
+  _packed_alternate_table = ptmp;
+
   unsigned* t = _last_changed;
   
   _last_changed = _next_changed;
@@ -177,7 +230,31 @@ static inline void swap_tables (void)
 }
 
 ///////////////////////////// Default tiling
-int life_do_tile_default (int x, int y, int width, int height)
+// Cells of the image border never change: only border tiles need to check
+// for them
+int life_do_tile_default_inner (int x, int y, int width, int height)
+{
+  int change = 0;
+
+  for (int i = y; i < y + height; i++)
+    for (int j = x; j < x + width; j++) {
+      unsigned n  = 0;
+      unsigned me = cur_table (i, j);
+
+      for (int yloc = i - 1; yloc < i + 2; yloc++)
+        for (int xloc = j - 1; xloc < j + 2; xloc++)
+          n += cur_table (yloc, xloc);
+
+      n = (n == 3 + me) | (n == 3);
+      change |= (n != me);
+
+      next_table (i, j) = n;
+    }
+
+  return change;
+}
+
+int life_do_tile_default_border (int x, int y, int width, int height)
 {
   int change = 0;
 
@@ -201,6 +278,245 @@ int life_do_tile_default (int x, int y, int width, int height)
   return change;
 }
 
+///////////////////////////// Bit-packed tiling (bitpacked)
+// Suggested cmdline:
+// ./run -k life -s 2176 -a otca_off -ts 64 -v omp_tiled -wt bitpacked
+//
+// 64 cells are updated at once using bit-sliced full-adders. Works with the
+// seq, tiled, omp_tiled and omp_tiled_lazy variants.
+
+void life_tile_check_bitpacked (void)
+{
+  if (DIM % WORD_BITS)
+    exit_with_error ("DIM (%d) must be a multiple of %d for bitpacked tiling",
+                     DIM, WORD_BITS);
+
+  if (TILE_W % WORD_BITS)
+    exit_with_error ("Tile width (%d) must be a multiple of %d for bitpacked "
+                     "tiling", TILE_W, WORD_BITS);
+}
+
+// Word whose bit b holds the left (resp. right) neighbour of cell b
+static inline word_t west (word_t *restrict row, int w)
+{
+  return (row[w] << 1) | (w > 0 ? row[w - 1] >> (WORD_BITS - 1) : 0);
+}
+
+static inline word_t east (word_t *restrict row, int w)
+{
+  return (row[w] >> 1) |
+         (w < WORDS_PER_ROW - 1 ? row[w + 1] << (WORD_BITS - 1) : 0);
+}
+
+// Applies B3/S23 to 64 cells at once, given the words holding their
+// north-west, north, ..., south-east neighbours
+static inline word_t life_rule (word_t ul, word_t u, word_t ur, word_t ml,
+                                word_t me, word_t mr, word_t dl, word_t d,
+                                word_t dr)
+{
+  // 2-bit horizontal sums of the upper, middle and lower rows
+  word_t u0 = ul ^ u ^ ur, u1 = (ul & u) | (ur & (ul ^ u));
+  word_t m0 = ml ^ mr, m1 = ml & mr;
+  word_t d0 = dl ^ d ^ dr, d1 = (dl & d) | (dr & (dl ^ d));
+
+  // n = n0 + 2 * n1 + 4 * n2 + 8 * n3 = sum of the 8 neighbours
+  word_t n0 = u0 ^ m0 ^ d0;
+  word_t c0 = (u0 & m0) | (d0 & (u0 ^ m0));
+  word_t s1 = u1 ^ m1 ^ d1;
+  word_t c1 = (u1 & m1) | (d1 & (u1 ^ m1));
+  word_t n1 = s1 ^ c0;
+  word_t c2 = s1 & c0;
+  word_t n2 = c1 ^ c2;
+  word_t n3 = c1 & c2;
+
+  // n == 3 || (n == 2 && alive)
+  return ~n3 & ~n2 & n1 & (n0 | me);
+}
+
+int life_do_tile_bitpacked (int x, int y, int width, int height)
+{
+  word_t change = 0;
+  const int i_start = max (y, 1);
+  const int i_end   = min (y + height, (int)DIM - 1);
+
+  for (int i = i_start; i < i_end; i++) {
+    word_t *up = cur_packed_row (i - 1);
+    word_t *me = cur_packed_row (i);
+    word_t *down = cur_packed_row (i + 1);
+    word_t *out = next_packed_row (i);
+
+    for (int w = x / WORD_BITS; w < (x + width) / WORD_BITS; w++) {
+      word_t ul = west (up, w), ur = east (up, w);
+      word_t ml = west (me, w), mr = east (me, w);
+      word_t dl = west (down, w), dr = east (down, w);
+
+      word_t next = life_rule (ul, up[w], ur, ml, me[w], mr, dl, down[w], dr);
+
+      // Cells on the image border never change
+      if (w == 0)
+        next &= ~(word_t)1;
+      if (w == WORDS_PER_ROW - 1)
+        next &= ~((word_t)1 << (WORD_BITS - 1));
+
+      change |= next ^ me[w];
+      out[w] = next;
+    }
+  }
+
+  return change != 0;
+}
+
+///////////////////////////// Vectorized tilings (avx2, avx512)
+// Suggested cmdline:
+// ./run -k life -s 2176 -a otca_off -ts 64 -v omp_tiled -wt avx2
+//
+// The vertical sum of each column (three rows) is computed once per vector,
+// then the horizontal neighbours are obtained by sliding lanes between the
+// previous, current and next vectors instead of reloading memory.
+
+#ifdef ENABLE_VECTO
+#include <immintrin.h>
+
+#if __AVX2__ == 1
+
+void life_tile_check_avx2 (void)
+{
+  // Tile width must be larger than AVX vector size
+  easypap_vec_check (AVX_VEC_SIZE_INT, DIR_HORIZONTAL);
+}
+
+static inline __m256i vertical_sum_avx2 (int i, int j)
+{
+  if (j < 0 || j >= DIM)
+    return _mm256_setzero_si256 ();
+
+  __m256i up   = _mm256_loadu_si256 ((__m256i *)&cur_table (i - 1, j));
+  __m256i me   = _mm256_loadu_si256 ((__m256i *)&cur_table (i, j));
+  __m256i down = _mm256_loadu_si256 ((__m256i *)&cur_table (i + 1, j));
+
+  return _mm256_add_epi32 (_mm256_add_epi32 (up, me), down);
+}
+
+int life_do_tile_avx2 (int x, int y, int width, int height)
+{
+  const __m256i one   = _mm256_set1_epi32 (1);
+  const __m256i three = _mm256_set1_epi32 (3);
+  __m256i change      = _mm256_setzero_si256 ();
+  const int i_start   = max (y, 1);
+  const int i_end     = min (y + height, (int)DIM - 1);
+
+  for (int i = i_start; i < i_end; i++) {
+    __m256i prev = vertical_sum_avx2 (i, x - AVX_VEC_SIZE_INT);
+    __m256i cur  = vertical_sum_avx2 (i, x);
+
+    for (int j = x; j < x + width; j += AVX_VEC_SIZE_INT) {
+      __m256i next = vertical_sum_avx2 (i, j + AVX_VEC_SIZE_INT);
+
+      // west = [prev7, cur0 .. cur6], east = [cur1 .. cur7, next0]
+      __m256i west = _mm256_alignr_epi8 (
+          cur, _mm256_permute2x128_si256 (prev, cur, 0x21), 12);
+      __m256i east = _mm256_alignr_epi8 (
+          _mm256_permute2x128_si256 (cur, next, 0x21), cur, 4);
+
+      // n includes the cell itself
+      __m256i n  = _mm256_add_epi32 (_mm256_add_epi32 (west, cur), east);
+      __m256i me = _mm256_loadu_si256 ((__m256i *)&cur_table (i, j));
+
+      __m256i alive = _mm256_or_si256 (
+          _mm256_cmpeq_epi32 (n, three),
+          _mm256_cmpeq_epi32 (n, _mm256_add_epi32 (me, three)));
+      alive = _mm256_and_si256 (alive, one);
+
+      // Cells on the image border never change
+      if (j == 0)
+        alive = _mm256_blend_epi32 (alive, me, 0x01);
+      if (j + AVX_VEC_SIZE_INT == DIM)
+        alive = _mm256_blend_epi32 (alive, me, 0x80);
+
+      change = _mm256_or_si256 (change, _mm256_xor_si256 (alive, me));
+      _mm256_storeu_si256 ((__m256i *)&next_table (i, j), alive);
+
+      prev = cur;
+      cur  = next;
+    }
+  }
+
+  return !_mm256_testz_si256 (change, change);
+}
+
+#endif // AVX2
+
+#if __AVX512F__ == 1
+
+void life_tile_check_avx512 (void)
+{
+  // Tile width must be larger than AVX-512 vector size
+  easypap_vec_check (AVX512_VEC_SIZE_INT, DIR_HORIZONTAL);
+}
+
+static inline __m512i vertical_sum_avx512 (int i, int j)
+{
+  if (j < 0 || j >= DIM)
+    return _mm512_setzero_si512 ();
+
+  __m512i up   = _mm512_loadu_si512 (&cur_table (i - 1, j));
+  __m512i me   = _mm512_loadu_si512 (&cur_table (i, j));
+  __m512i down = _mm512_loadu_si512 (&cur_table (i + 1, j));
+
+  return _mm512_add_epi32 (_mm512_add_epi32 (up, me), down);
+}
+
+int life_do_tile_avx512 (int x, int y, int width, int height)
+{
+  const __m512i one   = _mm512_set1_epi32 (1);
+  const __m512i three = _mm512_set1_epi32 (3);
+  __mmask16 change    = 0;
+  const int i_start   = max (y, 1);
+  const int i_end     = min (y + height, (int)DIM - 1);
+
+  for (int i = i_start; i < i_end; i++) {
+    __m512i prev = vertical_sum_avx512 (i, x - AVX512_VEC_SIZE_INT);
+    __m512i cur  = vertical_sum_avx512 (i, x);
+
+    for (int j = x; j < x + width; j += AVX512_VEC_SIZE_INT) {
+      __m512i next = vertical_sum_avx512 (i, j + AVX512_VEC_SIZE_INT);
+
+      // west = [prev15, cur0 .. cur14], east = [cur1 .. cur15, next0]
+      __m512i west = _mm512_alignr_epi32 (cur, prev, 15);
+      __m512i east = _mm512_alignr_epi32 (next, cur, 1);
+
+      // n includes the cell itself
+      __m512i n  = _mm512_add_epi32 (_mm512_add_epi32 (west, cur), east);
+      __m512i me = _mm512_loadu_si512 (&cur_table (i, j));
+
+      __mmask16 alive = _mm512_cmpeq_epi32_mask (n, three) |
+                        _mm512_cmpeq_epi32_mask (n, _mm512_add_epi32 (me, three));
+
+      // Cells on the image border never change
+      __mmask16 border = 0;
+      if (j == 0)
+        border |= 0x0001;
+      if (j + AVX512_VEC_SIZE_INT == DIM)
+        border |= 0x8000;
+
+      __m512i res = _mm512_mask_blend_epi32 (
+          border, _mm512_maskz_mov_epi32 (alive, one), me);
+
+      change |= _mm512_cmpneq_epi32_mask (res, me);
+      _mm512_storeu_si512 (&next_table (i, j), res);
+
+      prev = cur;
+      cur  = next;
+    }
+  }
+
+  return change != 0;
+}
+
+#endif // AVX512
+
+#endif // ENABLE_VECTO
+
 ///////////////////////////// Sequential version (seq)
 //
 unsigned life_compute_seq (unsigned nb_iter)
@@ -395,19 +711,916 @@ unsigned life_compute_omp_tiled_lazy (unsigned nb_iter)
   return res;
 }
 
+///////////////////////////// Sparse worklist version (omp_tiled_sparse)
+// Suggested cmdline:
+// ./run -k life -s 8192 -a random -ts 32 -v omp_tiled_sparse -m
+//
+// Instead of probing the 3x3 neighbourhood of every tile at each iteration,
+// we keep a compact list of the tiles which may change. Each thread records
+// the tiles it saw changing, then inserts their neighbours in the next list
+// (a per-tile flag prevents duplicates). The length of the list is recorded
+// in traces at each iteration.
+
+enum
+{
+  TASKID_WORKLIST
+};
+
+static char *task_ids[] = {"Worklist update", NULL};
+
+static unsigned *restrict _worklist = NULL, *restrict _thread_tiles = NULL;
+static unsigned char *restrict _queued = NULL;
+static unsigned *_thread_count = NULL, *_thread_offset = NULL;
+static unsigned worklist_size = 0;
+
+#define NB_TILES ((DIM / TILE_W) * (DIM / TILE_H))
+
+// Per-thread buffers, large enough to hold every tile twice (changed tiles
+// followed by the neighbours they queued)
+#define thread_tiles(t) (_thread_tiles + 2 * (t) * NB_TILES)
+
+void life_init_omp_tiled_sparse (void)
+{
+  const unsigned nb_threads = omp_get_max_threads ();
+
+  life_init ();
+
+  monitoring_declare_task_ids (task_ids);
+
+  _worklist      = malloc (NB_TILES * sizeof (unsigned));
+  _thread_tiles  = malloc (2 * nb_threads * NB_TILES * sizeof (unsigned));
+  _thread_count  = calloc (nb_threads, sizeof (unsigned));
+  _thread_offset = calloc (nb_threads, sizeof (unsigned));
+  _queued        = calloc (NB_TILES, sizeof (unsigned char));
+
+  if (_worklist == NULL || _thread_tiles == NULL || _queued == NULL)
+    exit_with_error ("Cannot allocate worklist buffers");
+
+  // Initially, every tile has to be computed
+  for (unsigned t = 0; t < NB_TILES; t++)
+    _worklist[t] = t;
+  worklist_size = NB_TILES;
+
+  PRINT_DEBUG ('u', "Worklist footprint = %ld bytes\n",
+               (long)(2 * nb_threads + 1) * NB_TILES * sizeof (unsigned));
+}
+
+void life_finalize_omp_tiled_sparse (void)
+{
+  free (_worklist);
+  free (_thread_tiles);
+  free (_thread_count);
+  free (_thread_offset);
+  free (_queued);
+
+  life_finalize ();
+}
+
+// Insert the (not yet queued) neighbours of the tiles changed by thread t
+static void worklist_expand (unsigned t, unsigned nb_changed)
+{
+  unsigned *restrict changed = thread_tiles (t);
+  unsigned *restrict next    = changed + nb_changed;
+  unsigned n                 = 0;
+
+  for (unsigned i = 0; i < nb_changed; i++) {
+    const int ty = changed[i] / (DIM / TILE_W);
+    const int tx = changed[i] % (DIM / TILE_W);
+
+    for (int y = max (ty - 1, 0); y <= min (ty + 1, DIM / TILE_H - 1); y++)
+      for (int x = max (tx - 1, 0); x <= min (tx + 1, DIM / TILE_W - 1); x++) {
+        const unsigned tile = y * (DIM / TILE_W) + x;
+
+        if (!__atomic_exchange_n (&_queued[tile], 1, __ATOMIC_RELAXED))
+          next[n++] = tile;
+      }
+  }
+
+  // The list of changed tiles is not needed anymore
+  memmove (changed, next, n * sizeof (unsigned));
+  _thread_count[t] = n;
+}
+
+unsigned life_compute_omp_tiled_sparse (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    // easyview displays the number of active tiles when hovering an
+    // iteration
+    monitoring_counter (worklist_size);
+
+    PRINT_DEBUG ('m', "Iteration %u: %u active tiles out of %u\n", it,
+                 worklist_size, NB_TILES);
+
+    #pragma omp parallel
+    {
+      const unsigned me = omp_get_thread_num ();
+      unsigned nb_changed = 0;
+
+      #pragma omp for schedule(dynamic) nowait
+      for (unsigned i = 0; i < worklist_size; i++) {
+        const unsigned tile = _worklist[i];
+        const int x         = (tile % (DIM / TILE_W)) * TILE_W;
+        const int y         = (tile / (DIM / TILE_W)) * TILE_H;
+
+        if (do_tile (x, y, TILE_W, TILE_H, me))
+          thread_tiles (me)[nb_changed++] = tile;
+      }
+
+      monitoring_start_tile (me);
+
+      worklist_expand (me, nb_changed);
+
+      #pragma omp barrier
+
+      #pragma omp single
+      {
+        unsigned offset = 0;
+        for (int t = 0; t < omp_get_num_threads (); t++) {
+          _thread_offset[t] = offset;
+          offset += _thread_count[t];
+        }
+        worklist_size = offset;
+      }
+
+      // Concatenate the per-thread lists and reset the queued flags
+      memcpy (_worklist + _thread_offset[me], thread_tiles (me),
+              _thread_count[me] * sizeof (unsigned));
+      for (unsigned i = 0; i < _thread_count[me]; i++)
+        _queued[thread_tiles (me)[i]] = 0;
+
+      // The worklist update has no associated tile
+      monitoring_end_tile_id (0, 0, 0, 0, me, TASKID_WORKLIST);
+    }
+
+    swap_tables ();
+
+    if (worklist_size == 0) { // we stop if all cells are stable
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+///////////////////////////// Temporal blocking version (omp_tiled_temporal)
+// Suggested cmdline:
+// TEMPORAL_DEPTH=8 ./run -k life -s 8192 -a random -ts 64 -v omp_tiled_temporal
+//
+// Each tile is loaded along with a halo of depth k into a private buffer,
+// and advanced k generations in cache before being written back. The halo
+// shrinks by one cell at each generation (overlapped tiling), so tiles never
+// have to wait for their neighbours. k is set with the TEMPORAL_DEPTH
+// environment variable (default 4).
+
+static unsigned temporal_depth = 4;
+
+// Per-thread pairs of halo buffers, sized for temporal_depth
+static cell_t *_halo_buffers = NULL;
+static unsigned halo_size    = 0;
+
+#define halo_buffer(t) (_halo_buffers + 2 * (t) * halo_size)
+
+void life_init_omp_tiled_temporal (void)
+{
+  char *str = getenv ("TEMPORAL_DEPTH");
+
+  life_init ();
+
+  if (bitpacked)
+    exit_with_error ("omp_tiled_temporal variant cannot be used with "
+                     "bitpacked tiling");
+
+  if (str != NULL) {
+    temporal_depth = atoi (str);
+    if (temporal_depth == 0)
+      exit_with_error ("TEMPORAL_DEPTH must be a positive integer (%s)", str);
+  }
+
+  halo_size =
+      (TILE_H + 2 * temporal_depth) * (TILE_W + 2 * temporal_depth);
+  _halo_buffers =
+      malloc (2 * omp_get_max_threads () * halo_size * sizeof (cell_t));
+  if (_halo_buffers == NULL)
+    exit_with_error ("Cannot allocate halo buffers");
+
+  PRINT_DEBUG ('u', "Temporal blocking depth: %u\n", temporal_depth);
+}
+
+void life_finalize_omp_tiled_temporal (void)
+{
+  free (_halo_buffers);
+
+  life_finalize ();
+}
+
+// Advances tile (x, y) by depth generations using the two buffers a and b,
+// and returns the last generation (in [1..depth]) which changed the tile, or
+// 0 if it did not change at all
+static unsigned life_temporal_tile (int x, int y, unsigned depth,
+                                    cell_t *restrict a, cell_t *restrict b)
+{
+  const int k = depth, H = TILE_H + 2 * k, W = TILE_W + 2 * k;
+  const int y0 = y - k, x0 = x - k;
+  cell_t *restrict src = a, *restrict dst = b;
+  unsigned last = 0;
+
+  // Cells lying outside of the image are dead. Border cells and cells
+  // outside of the image are never updated, so both buffers hold them.
+  for (int r = 0; r < H; r++)
+    for (int c = 0; c < W; c++) {
+      const int i = y0 + r, j = x0 + c;
+      const cell_t v =
+          (i >= 0 && i < DIM && j >= 0 && j < DIM) ? cur_table (i, j) : 0;
+
+      a[r * W + c] = b[r * W + c] = v;
+    }
+
+  for (int g = 1; g <= k; g++) {
+    // Only cells which are at least g cells away from the buffer edges are
+    // valid at generation g
+    const int r_start = max (g, 1 - y0), r_end = min (H - g, DIM - 1 - y0);
+    const int c_start = max (g, 1 - x0), c_end = min (W - g, DIM - 1 - x0);
+    unsigned change   = 0;
+
+    for (int r = r_start; r < r_end; r++)
+      for (int c = c_start; c < c_end; c++) {
+        const cell_t me = src[r * W + c];
+        unsigned n      = 0;
+
+        for (int yloc = r - 1; yloc < r + 2; yloc++)
+          for (int xloc = c - 1; xloc < c + 2; xloc++)
+            n += src[yloc * W + xloc];
+
+        n = (n == 3 + me) | (n == 3);
+
+        // Only changes inside the tile matter, the halo belongs to neighbours
+        if (r >= k && r < k + TILE_H && c >= k && c < k + TILE_W)
+          change |= (n != me);
+
+        dst[r * W + c] = n;
+      }
+
+    if (change)
+      last = g;
+
+    cell_t *tmp = src;
+    src         = dst;
+    dst         = tmp;
+  }
+
+  for (int r = k; r < k + TILE_H; r++)
+    for (int c = k; c < k + TILE_W; c++)
+      next_table (y0 + r, x0 + c) = src[r * W + c];
+
+  return last;
+}
+
+unsigned life_compute_omp_tiled_temporal (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it += temporal_depth) {
+    const unsigned depth = min (temporal_depth, nb_iter - it + 1);
+    // The last block of iterations may be shallower than temporal_depth
+    const unsigned size = (TILE_H + 2 * depth) * (TILE_W + 2 * depth);
+    unsigned last       = 0;
+
+    #pragma omp parallel for schedule(runtime) collapse(2) reduction(max : last)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W) {
+        cell_t *buffer = halo_buffer (omp_get_thread_num ());
+
+        monitoring_start_tile (omp_get_thread_num ());
+
+        last =
+            max (last, life_temporal_tile (x, y, depth, buffer, buffer + size));
+
+        monitoring_end_tile (x, y, TILE_W, TILE_H, omp_get_thread_num ());
+      }
+
+    swap_tables ();
+
+    // Generation it + last did not change anything: we stop
+    if (last < depth) {
+      res = it + last;
+      break;
+    }
+  }
+
+  return res;
+}
+
+///////////////////////////// Persistent thread team version (team)
+// Suggested cmdline:
+// ./run -k life -s 256 -a random -ts 16 -v team -i 10000 -n
+//
+// Same as omp_tiled, but the threads of the team are spawned only once and
+// synchronize with a spin barrier at each iteration.
+
+void life_init_team (void)
+{
+  life_init ();
+
+  team_init (easypap_requested_number_of_threads ());
+}
+
+static unsigned team_res;
+
+static void life_team_body (unsigned me, void *arg)
+{
+  const unsigned nb_iter = *(unsigned *)arg;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    const int change = team_for_tiles (me);
+
+    if (me == 0)
+      swap_tables ();
+
+    team_barrier (me);
+
+    // All members agree on change, so they leave the loop together
+    if (!change) { // we stop if all cells are stable
+      if (me == 0)
+        team_res = it;
+      break;
+    }
+  }
+}
+
+unsigned life_compute_team (unsigned nb_iter)
+{
+  team_res = 0;
+
+  team_run (life_team_body, &nb_iter);
+
+  return team_res;
+}
+
+///////////////////////////// Hashlife version (hashlife)
+// Suggested cmdline:
+// ./run -k life -s 2176 -a otca_off -v hashlife -i 50000 -n
+//
+// The board is stored as a canonical (hash-consed) quadtree whose successors
+// are memoized, so that periodic patterns are advanced by 2^k generations at a
+// very low cost. _table is only materialized when pixels are needed.
+// Image border cells are stored as "frozen" cells which keep their state
+// forever, exactly as they do with the other variants. Cells lying outside of
+// the image are frozen dead cells, so the image is centered in an empty (and
+// frozen) universe.
+
+#define HL_LEAF_LEVEL 3        // 8x8 leaves are stored as bitmaps
+#define HL_BASE_LEVEL 5        // 32x32 nodes are advanced by brute force
+#define HL_MAX_NODES (1 << 22) // above this, the node cache is rebuilt
+#define HL_CHUNK_SIZE 65536
+#define HL_MAX_LEVEL 32
+
+typedef struct hl_node
+{
+  union
+  {
+    struct
+    {
+      struct hl_node *nw, *ne, *sw, *se;
+    };
+    struct
+    {
+      uint64_t alive, frozen; // leaves only
+    };
+  };
+  struct hl_node *result; // center advanced by 2^(level - 2) generations
+  struct hl_node *next;   // hash chain
+  unsigned level;
+} hl_node_t;
+
+typedef struct hl_chunk
+{
+  struct hl_chunk *prev;
+  hl_node_t nodes[HL_CHUNK_SIZE];
+} hl_chunk_t;
+
+// Results of slower (2^s generations, s < level - 2) steps
+typedef struct
+{
+  hl_node_t *node, *result;
+  unsigned step;
+} hl_memo_t;
+
+static hl_chunk_t *hl_chunks    = NULL;
+static unsigned hl_chunk_used   = HL_CHUNK_SIZE;
+static unsigned long hl_nb_nodes = 0;
+
+static hl_node_t **hl_hash       = NULL;
+static unsigned long hl_hash_size = 0;
+
+static hl_memo_t *hl_memo         = NULL;
+static unsigned long hl_memo_size  = 0;
+static unsigned long hl_memo_count = 0;
+
+static hl_node_t *hl_empty[HL_MAX_LEVEL];
+static hl_node_t *hl_root = NULL;
+static unsigned hl_level; // level of the smallest node containing the image
+
+static inline uint64_t hl_mix (uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static inline uint64_t hl_hash_of (uint64_t a, uint64_t b, uint64_t c,
+                                   uint64_t d)
+{
+  return hl_mix (a + hl_mix (b + hl_mix (c + hl_mix (d))));
+}
+
+static inline uint64_t hl_hash_node (hl_node_t *n)
+{
+  if (n->level == HL_LEAF_LEVEL)
+    return hl_hash_of (n->alive, n->frozen, 0, 0);
+
+  return hl_hash_of ((uintptr_t)n->nw, (uintptr_t)n->ne, (uintptr_t)n->sw,
+                     (uintptr_t)n->se);
+}
+
+static void hl_hash_grow (void)
+{
+  unsigned long size = hl_hash_size ? 2 * hl_hash_size : 1 << 16;
+  hl_node_t **hash   = calloc (size, sizeof (hl_node_t *));
+
+  for (unsigned long i = 0; i < hl_hash_size; i++)
+    for (hl_node_t *n = hl_hash[i], *next; n != NULL; n = next) {
+      unsigned long h = hl_hash_node (n) & (size - 1);
+      next            = n->next;
+      n->next         = hash[h];
+      hash[h]         = n;
+    }
+
+  free (hl_hash);
+  hl_hash      = hash;
+  hl_hash_size = size;
+}
+
+static hl_node_t *hl_alloc (unsigned level, unsigned long h)
+{
+  if (hl_chunk_used == HL_CHUNK_SIZE) {
+    hl_chunk_t *c = malloc (sizeof (hl_chunk_t));
+    if (c == NULL)
+      exit_with_error ("Cannot allocate hashlife nodes");
+    c->prev       = hl_chunks;
+    hl_chunks     = c;
+    hl_chunk_used = 0;
+  }
+
+  hl_node_t *n = &hl_chunks->nodes[hl_chunk_used++];
+
+  n->level  = level;
+  n->result = NULL;
+  n->next   = hl_hash[h];
+  hl_hash[h] = n;
+
+  if (++hl_nb_nodes > hl_hash_size)
+    hl_hash_grow ();
+
+  return n;
+}
+
+static hl_node_t *hl_leaf (uint64_t alive, uint64_t frozen)
+{
+  unsigned long h = hl_hash_of (alive, frozen, 0, 0) & (hl_hash_size - 1);
+
+  for (hl_node_t *n = hl_hash[h]; n != NULL; n = n->next)
+    if (n->level == HL_LEAF_LEVEL && n->alive == alive && n->frozen == frozen)
+      return n;
+
+  hl_node_t *n = hl_alloc (HL_LEAF_LEVEL, h);
+  n->alive     = alive;
+  n->frozen    = frozen;
+
+  return n;
+}
+
+static hl_node_t *hl_make (hl_node_t *nw, hl_node_t *ne, hl_node_t *sw,
+                           hl_node_t *se)
+{
+  unsigned long h = hl_hash_of ((uintptr_t)nw, (uintptr_t)ne, (uintptr_t)sw,
+                                (uintptr_t)se) &
+                    (hl_hash_size - 1);
+
+  for (hl_node_t *n = hl_hash[h]; n != NULL; n = n->next)
+    if (n->level != HL_LEAF_LEVEL && n->nw == nw && n->ne == ne &&
+        n->sw == sw && n->se == se)
+      return n;
+
+  hl_node_t *n = hl_alloc (nw->level + 1, h);
+  n->nw        = nw;
+  n->ne        = ne;
+  n->sw        = sw;
+  n->se        = se;
+
+  return n;
+}
+
+static hl_memo_t *hl_memo_slot (hl_node_t *n, unsigned step)
+{
+  unsigned long i = hl_hash_of ((uintptr_t)n, step, 0, 0) & (hl_memo_size - 1);
+
+  while (hl_memo[i].node != NULL &&
+         (hl_memo[i].node != n || hl_memo[i].step != step))
+    i = (i + 1) & (hl_memo_size - 1);
+
+  return &hl_memo[i];
+}
+
+static void hl_memo_insert (hl_node_t *n, unsigned step, hl_node_t *result)
+{
+  if (2 * (hl_memo_count + 1) > hl_memo_size) {
+    hl_memo_t *old         = hl_memo;
+    unsigned long old_size = hl_memo_size;
+
+    hl_memo_size = old_size ? 2 * old_size : 1 << 16;
+    hl_memo      = calloc (hl_memo_size, sizeof (hl_memo_t));
+
+    for (unsigned long i = 0; i < old_size; i++)
+      if (old[i].node != NULL)
+        *hl_memo_slot (old[i].node, old[i].step) = old[i];
+
+    free (old);
+  }
+
+  hl_memo_t *slot = hl_memo_slot (n, step);
+
+  slot->node   = n;
+  slot->step   = step;
+  slot->result = result;
+  hl_memo_count++;
+}
+
+// Collects the 16x16 (level 4) or 8x8 (leaf) node n into 32-bit rows
+static void hl_gather (hl_node_t *n, int y, int x, uint64_t *alive,
+                       uint64_t *frozen)
+{
+  if (n->level == HL_LEAF_LEVEL) {
+    for (int r = 0; r < 8; r++) {
+      alive[y + r] |= ((n->alive >> (8 * r)) & 0xFF) << x;
+      frozen[y + r] |= ((n->frozen >> (8 * r)) & 0xFF) << x;
+    }
+    return;
+  }
+
+  const int half = 1 << (n->level - 1);
+
+  hl_gather (n->nw, y, x, alive, frozen);
+  hl_gather (n->ne, y, x + half, alive, frozen);
+  hl_gather (n->sw, y + half, x, alive, frozen);
+  hl_gather (n->se, y + half, x + half, alive, frozen);
+}
+
+static hl_node_t *hl_scatter_leaf (uint64_t *alive, uint64_t *frozen, int y,
+                                   int x)
+{
+  uint64_t a = 0, f = 0;
+
+  for (int r = 0; r < 8; r++) {
+    a |= ((alive[y + r] >> x) & 0xFF) << (8 * r);
+    f |= ((frozen[y + r] >> x) & 0xFF) << (8 * r);
+  }
+
+  return hl_leaf (a, f);
+}
+
+// Advances the center (16x16) of a 32x32 node by 2^step generations
+static hl_node_t *hl_base (hl_node_t *n, unsigned step)
+{
+  const uint64_t mask = 0xFFFFFFFF;
+  uint64_t alive[32] = {0}, frozen[32] = {0}, next[32];
+
+  hl_gather (n, 0, 0, alive, frozen);
+
+  for (int g = 0; g < (1 << step); g++) {
+    // The valid area shrinks by one cell on each side at each generation
+    for (int r = g + 1; r < 31 - g; r++) {
+      word_t up = alive[r - 1], me = alive[r], down = alive[r + 1];
+      word_t res = life_rule (up << 1, up, up >> 1, me << 1, me, me >> 1,
+                              down << 1, down, down >> 1);
+
+      next[r] = ((res & ~frozen[r]) | (me & frozen[r])) & mask;
+    }
+    for (int r = g + 1; r < 31 - g; r++)
+      alive[r] = next[r];
+  }
+
+  return hl_make (hl_scatter_leaf (alive, frozen, 8, 8),
+                  hl_scatter_leaf (alive, frozen, 8, 16),
+                  hl_scatter_leaf (alive, frozen, 16, 8),
+                  hl_scatter_leaf (alive, frozen, 16, 16));
+}
+
+static inline hl_node_t *hl_center (hl_node_t *n)
+{
+  return hl_make (n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+}
+
+// Returns the center of n (level - 1) advanced by 2^step generations, with
+// step <= level - 2
+static hl_node_t *hl_successor (hl_node_t *n, unsigned step)
+{
+  const int full_speed = (step == n->level - 2);
+  hl_node_t *r;
+
+  if (full_speed) {
+    if (n->result != NULL)
+      return n->result;
+  } else if (hl_memo_count > 0) {
+    hl_memo_t *slot = hl_memo_slot (n, step);
+    if (slot->node != NULL)
+      return slot->result;
+  }
+
+  if (n == hl_empty[n->level])
+    r = hl_empty[n->level - 1];
+  else if (n->level == HL_BASE_LEVEL)
+    r = hl_base (n, step);
+  else {
+    // Nine overlapping sub-nodes of level - 1
+    hl_node_t *s[3][3] = {
+        {n->nw, hl_make (n->nw->ne, n->ne->nw, n->nw->se, n->ne->sw), n->ne},
+        {hl_make (n->nw->sw, n->nw->se, n->sw->nw, n->sw->ne),
+         hl_make (n->nw->se, n->ne->sw, n->sw->ne, n->se->nw),
+         hl_make (n->ne->sw, n->ne->se, n->se->nw, n->se->ne)},
+        {n->sw, hl_make (n->sw->ne, n->se->nw, n->sw->se, n->se->sw), n->se}};
+    hl_node_t *t[3][3];
+
+    // At full speed, the first half of the generations is computed here,
+    // otherwise we simply take the centers of the sub-nodes
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+        t[i][j] = full_speed ? hl_successor (s[i][j], step - 1)
+                             : hl_center (s[i][j]);
+
+    const unsigned sub_step = full_speed ? step - 1 : step;
+
+    r = hl_make (
+        hl_successor (hl_make (t[0][0], t[0][1], t[1][0], t[1][1]), sub_step),
+        hl_successor (hl_make (t[0][1], t[0][2], t[1][1], t[1][2]), sub_step),
+        hl_successor (hl_make (t[1][0], t[1][1], t[2][0], t[2][1]), sub_step),
+        hl_successor (hl_make (t[1][1], t[1][2], t[2][1], t[2][2]), sub_step));
+  }
+
+  if (full_speed)
+    n->result = r;
+  else
+    hl_memo_insert (n, step, r);
+
+  return r;
+}
+
+// The image is placed in the center of the root node, at this offset
+#define HL_OFFSET (1 << (hl_level - 1))
+
+static hl_node_t *hl_build (unsigned level, int y, int x)
+{
+  const int size = 1 << level;
+
+  if (y + size <= HL_OFFSET || x + size <= HL_OFFSET ||
+      y >= HL_OFFSET + (int)DIM || x >= HL_OFFSET + (int)DIM)
+    return hl_empty[level];
+
+  if (level == HL_LEAF_LEVEL) {
+    uint64_t alive = 0, frozen = 0;
+
+    for (int r = 0; r < 8; r++)
+      for (int c = 0; c < 8; c++) {
+        int i = y + r - HL_OFFSET, j = x + c - HL_OFFSET;
+
+        if (i <= 0 || i >= DIM - 1 || j <= 0 || j >= DIM - 1)
+          frozen |= (uint64_t)1 << (8 * r + c);
+        if (i >= 0 && i < DIM && j >= 0 && j < DIM && cur_table (i, j))
+          alive |= (uint64_t)1 << (8 * r + c);
+      }
+
+    return hl_leaf (alive, frozen);
+  }
+
+  const int half = size / 2;
+
+  return hl_make (hl_build (level - 1, y, x), hl_build (level - 1, y, x + half),
+                  hl_build (level - 1, y + half, x),
+                  hl_build (level - 1, y + half, x + half));
+}
+
+static void hl_materialize (hl_node_t *n, int y, int x)
+{
+  if (n == hl_empty[n->level])
+    return;
+
+  if (n->level == HL_LEAF_LEVEL) {
+    for (int r = 0; r < 8; r++)
+      for (int c = 0; c < 8; c++)
+        if ((n->alive >> (8 * r + c)) & 1)
+          cur_table (y + r - HL_OFFSET, x + c - HL_OFFSET) = 1;
+    return;
+  }
+
+  const int half = 1 << (n->level - 1);
+
+  hl_materialize (n->nw, y, x);
+  hl_materialize (n->ne, y, x + half);
+  hl_materialize (n->sw, y + half, x);
+  hl_materialize (n->se, y + half, x + half);
+}
+
+static void hl_reset (void)
+{
+  while (hl_chunks != NULL) {
+    hl_chunk_t *prev = hl_chunks->prev;
+    free (hl_chunks);
+    hl_chunks = prev;
+  }
+  hl_chunk_used = HL_CHUNK_SIZE;
+  hl_nb_nodes   = 0;
+
+  free (hl_hash);
+  hl_hash      = NULL;
+  hl_hash_size = 0;
+  hl_hash_grow ();
+
+  free (hl_memo);
+  hl_memo       = NULL;
+  hl_memo_size  = 0;
+  hl_memo_count = 0;
+
+  hl_empty[HL_LEAF_LEVEL] = hl_leaf (0, ~(uint64_t)0);
+  for (unsigned l = HL_LEAF_LEVEL + 1; l <= hl_level + 1; l++)
+    hl_empty[l] = hl_make (hl_empty[l - 1], hl_empty[l - 1], hl_empty[l - 1],
+                           hl_empty[l - 1]);
+
+  hl_root = NULL;
+}
+
+// Copy the quadtree into _table
+static void hl_sync_table (void)
+{
+  memset (_table, 0, DIM * DIM * sizeof (cell_t));
+  hl_materialize (hl_root, 0, 0);
+}
+
+// Rebuild the node cache from scratch when it grows too large
+static void hl_collect (void)
+{
+  PRINT_DEBUG ('u', "Hashlife: collecting %lu nodes\n", hl_nb_nodes);
+
+  hl_sync_table ();
+  hl_reset ();
+  hl_root = hl_build (hl_level + 1, 0, 0);
+}
+
+// The result of hl_successor is the central part of the root node, which
+// exactly contains the image. We put it back in the middle of an empty root.
+static hl_node_t *hl_expand (hl_node_t *c)
+{
+  hl_node_t *e = hl_empty[c->level - 1];
+
+  return hl_make (hl_make (e, e, e, c->nw), hl_make (e, e, c->ne, e),
+                  hl_make (e, c->sw, e, e), hl_make (c->se, e, e, e));
+}
+
+static hl_node_t *hl_advance (hl_node_t *root, unsigned long nb_gen)
+{
+  while (nb_gen > 0) {
+    unsigned step = 0;
+
+    while (step < hl_level - 1 && (2UL << step) <= nb_gen)
+      step++;
+
+    root = hl_expand (hl_successor (root, step));
+    nb_gen -= 1UL << step;
+  }
+
+  return root;
+}
+
+static inline int hl_is_stable (hl_node_t *root)
+{
+  return hl_advance (root, 1) == root;
+}
+
+void life_init_hashlife (void)
+{
+  life_init ();
+
+  if (bitpacked)
+    exit_with_error ("hashlife variant cannot be used with bitpacked tiling");
+
+  hl_level = HL_BASE_LEVEL;
+  while ((1U << hl_level) < DIM)
+    hl_level++;
+
+  hl_reset ();
+}
+
+void life_finalize_hashlife (void)
+{
+  hl_reset ();
+
+  free (hl_hash);
+  hl_hash = NULL;
+  free (hl_memo);
+  hl_memo = NULL;
+
+  life_finalize ();
+}
+
+void life_refresh_img_hashlife (void)
+{
+  if (hl_root != NULL)
+    hl_sync_table ();
+
+  life_refresh_img ();
+}
+
+unsigned life_compute_hashlife (unsigned nb_iter)
+{
+  unsigned res = 0, done = 0, start = 0;
+
+  monitoring_start_tile (0);
+
+  if (hl_root == NULL)
+    hl_root = hl_build (hl_level + 1, 0, 0);
+
+  hl_node_t *first = hl_root;
+
+  while (done < nb_iter) {
+    // Collecting after the board became stable would prevent us from
+    // finding the exact iteration at which it happened
+    if (hl_nb_nodes > HL_MAX_NODES && !hl_is_stable (hl_root)) {
+      hl_collect ();
+      first = hl_root;
+      start = done;
+    }
+
+    hl_node_t *prev = hl_root;
+    unsigned step   = 0;
+
+    while (step < hl_level - 1 && (2UL << step) <= nb_iter - done)
+      step++;
+
+    hl_root = hl_advance (hl_root, 1UL << step);
+    done += 1U << step;
+
+    // Nothing will ever change anymore
+    if (hl_root == prev && hl_is_stable (hl_root))
+      break;
+  }
+
+  if (hl_is_stable (hl_root)) {
+    // Like other variants, return the first iteration that did not change
+    // anything, so we look for the first stable generation
+    unsigned lo = start, hi = done;
+
+    while (lo < hi) {
+      unsigned mid = lo + (hi - lo) / 2;
+
+      if (hl_is_stable (hl_advance (first, mid - start)))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+
+    if (lo < nb_iter)
+      res = lo + 1;
+  }
+
+  monitoring_end_tile (0, 0, DIM, DIM, 0);
+
+  return res;
+}
+
 ///////////////////////////// Initial configs
 
 void life_draw_guns (void);
 
 static inline void set_cell (int y, int x)
 {
-  cur_table (y, x) = 1;
+  if (bitpacked)
+    cur_packed_row (y)[x / WORD_BITS] |= (word_t)1 << (x % WORD_BITS);
+  else
+    cur_table (y, x) = 1;
   if (opencl_used)
     cur_img (y, x) = 1;
 }
 
 static inline int get_cell (int y, int x)
 {
+  if (bitpacked)
+    return (cur_packed_row (y)[x / WORD_BITS] >> (x % WORD_BITS)) & 1;
+
   return cur_table (y, x);
 }
 
@@ -5,6 +5,7 @@
 
 
 static unsigned compute_one_pixel (int i, int j);
+static unsigned iteration_to_color (unsigned iter);
 static void zoom (void);
 
 
@@ -84,6 +85,9 @@ static float bottomY = .648;
 static float xstep;
 static float ystep;
 
+// Colors of all iteration counts, so that vectorized tiles can gather them
+static unsigned color_lut[MAX_ITERATIONS + 1];
+
 void mandel_init ()
 {
   // check tile size's conformity with respect to CPU vector width
@@ -91,6 +95,9 @@ void mandel_init ()
 
   xstep = (rightX - leftX) / DIM;
   ystep = (topY - bottomY) / DIM;
+
+  for (unsigned iter = 0; iter <= MAX_ITERATIONS; iter++)
+    color_lut[iter] = iteration_to_color (iter);
 }
 
 static unsigned iteration_to_color (unsigned iter)
@@ -135,7 +142,7 @@ static void zoom (void)
   ystep = (topY - bottomY) / DIM;
 }
 
-static unsigned compute_one_pixel (int i, int j)
+static unsigned compute_one_iter (int i, int j)
 {
   float cr = leftX + xstep * j;
   float ci = topY - ystep * i;
@@ -159,7 +166,225 @@ static unsigned compute_one_pixel (int i, int j)
     zi = twoxy + ci;
   }
 
-  return iteration_to_color (iter);
+  return iter;
+}
+
+static unsigned compute_one_pixel (int i, int j)
+{
+  return color_lut[compute_one_iter (i, j)];
+}
+
+///////////////////////////// Mariani-Silver subdivision (ms)
+// Suggested cmdline:
+// ./run -k mandel -v omp_tiled -wt ms -ts 64
+//
+// The border of a rectangle is computed first: when all border pixels share
+// the same iteration count, the inside is filled without computing it (this
+// relies on the connectedness of the set). Otherwise the rectangle is split
+// into four. Points lying in the main cardioid or in the period-2 bulb are
+// detected analytically instead of running MAX_ITERATIONS iterations.
+
+#define MS_MIN_SIZE 4
+#define MS_MAX_SIZE 64
+
+typedef struct
+{
+  int x, y, width;
+  int *iters; // iteration counts of the tile, -1 when not computed yet
+} ms_tile_t;
+
+static inline int in_main_bulbs (float cr, float ci)
+{
+  const float ci2 = ci * ci;
+  const float q   = (cr - 0.25f) * (cr - 0.25f) + ci2;
+
+  return q * (q + (cr - 0.25f)) <= 0.25f * ci2 ||
+         (cr + 1.0f) * (cr + 1.0f) + ci2 <= 0.0625f;
+}
+
+static int ms_iter (ms_tile_t *t, int i, int j)
+{
+  int *it = &t->iters[(i - t->y) * t->width + (j - t->x)];
+
+  if (*it < 0)
+    *it = in_main_bulbs (leftX + xstep * j, topY - ystep * i)
+              ? MAX_ITERATIONS
+              : compute_one_iter (i, j);
+
+  return *it;
+}
+
+static void ms_rect (ms_tile_t *t, int x, int y, int w, int h)
+{
+  if (w <= MS_MIN_SIZE || h <= MS_MIN_SIZE) {
+    for (int i = y; i < y + h; i++)
+      for (int j = x; j < x + w; j++)
+        cur_img (i, j) = iteration_to_color (ms_iter (t, i, j));
+    return;
+  }
+
+  const int first = ms_iter (t, y, x);
+  int uniform     = 1;
+
+  for (int j = x; j < x + w && uniform; j++)
+    uniform = ms_iter (t, y, j) == first && ms_iter (t, y + h - 1, j) == first;
+  for (int i = y + 1; i < y + h - 1 && uniform; i++)
+    uniform = ms_iter (t, i, x) == first && ms_iter (t, i, x + w - 1) == first;
+
+  if (uniform) {
+    const unsigned color = iteration_to_color (first);
+
+    for (int i = y; i < y + h; i++)
+      for (int j = x; j < x + w; j++)
+        cur_img (i, j) = color;
+    return;
+  }
+
+  const int hw = w / 2, hh = h / 2;
+
+  ms_rect (t, x, y, hw, hh);
+  ms_rect (t, x + hw, y, w - hw, hh);
+  ms_rect (t, x, y + hh, hw, h - hh);
+  ms_rect (t, x + hw, y + hh, w - hw, h - hh);
+}
+
+int mandel_do_tile_ms (int x, int y, int width, int height)
+{
+  // Larger tiles are subdivided, so that iteration counts fit on the stack
+  int iters[MS_MAX_SIZE * MS_MAX_SIZE];
+
+  for (int yy = y; yy < y + height; yy += MS_MAX_SIZE)
+    for (int xx = x; xx < x + width; xx += MS_MAX_SIZE) {
+      const int w = min (MS_MAX_SIZE, x + width - xx);
+      const int h = min (MS_MAX_SIZE, y + height - yy);
+      ms_tile_t t = {xx, yy, w, iters};
+
+      for (int k = 0; k < w * h; k++)
+        iters[k] = -1;
+
+      ms_rect (&t, xx, yy, w, h);
+    }
+
+  return 0;
+}
+
+
+///////////////////////////// Incremental re-rendering (omp_incremental)
+// Suggested cmdline:
+// ./run -k mandel -v omp_incremental -ts 32
+//
+// Iteration counts of the previous frame are kept: each pixel of the new
+// frame is reprojected into the previous viewport and reuses the count found
+// there when the 3x3 neighbourhood around it is uniform. Pixels close to a
+// discontinuity, or falling outside the previous viewport, are recomputed.
+// Since predictions accumulate errors, a full refresh is made every
+// INCREMENTAL_REFRESH frames.
+
+#define INCREMENTAL_REFRESH 16
+
+static unsigned *inc_iters = NULL, *inc_prev_iters = NULL;
+static float prev_leftX, prev_topY, prev_xstep, prev_ystep;
+static unsigned inc_frame = 0;
+
+#define inc_iter(i, j) inc_iters[(i) * DIM + (j)]
+#define inc_prev_iter(i, j) inc_prev_iters[(i) * DIM + (j)]
+
+void mandel_init_omp_incremental (void)
+{
+  mandel_init ();
+
+  inc_iters      = vec_huge_malloc (DIM * DIM * sizeof (unsigned));
+  inc_prev_iters = vec_huge_malloc (DIM * DIM * sizeof (unsigned));
+  if (inc_iters == NULL || inc_prev_iters == NULL)
+    exit_with_error ("Cannot allocate iteration count buffers");
+
+  img_data_register_table ("inc_iters", inc_iters, sizeof (unsigned));
+  img_data_register_table ("inc_prev_iters", inc_prev_iters,
+                           sizeof (unsigned));
+}
+
+void mandel_finalize_omp_incremental (void)
+{
+  vec_huge_free (inc_iters, DIM * DIM * sizeof (unsigned));
+  vec_huge_free (inc_prev_iters, DIM * DIM * sizeof (unsigned));
+}
+
+// Returns the iteration count predicted from the previous frame, or -1 when
+// the pixel has to be recomputed
+static int predicted_iter (int i, int j)
+{
+  const float pj = (leftX + xstep * j - prev_leftX) / prev_xstep;
+  const float pi = (prev_topY - (topY - ystep * i)) / prev_ystep;
+  const int pi0  = (int)(pi + 0.5f);
+  const int pj0  = (int)(pj + 0.5f);
+
+  if (pi < 0.0f || pj < 0.0f || pi0 < 1 || pi0 >= DIM - 1 || pj0 < 1 ||
+      pj0 >= DIM - 1)
+    return -1;
+
+  const unsigned iter = inc_prev_iter (pi0, pj0);
+
+  for (int ii = pi0 - 1; ii <= pi0 + 1; ii++)
+    for (int jj = pj0 - 1; jj <= pj0 + 1; jj++)
+      if (inc_prev_iter (ii, jj) != iter)
+        return -1;
+
+  return iter;
+}
+
+static unsigned incremental_tile (int x, int y, int width, int height,
+                                  int full, int cpu)
+{
+  unsigned recomputed = 0;
+
+  monitoring_start_tile (cpu);
+
+  for (int i = y; i < y + height; i++)
+    for (int j = x; j < x + width; j++) {
+      int iter = full ? -1 : predicted_iter (i, j);
+
+      if (iter < 0) {
+        iter = compute_one_iter (i, j);
+        recomputed++;
+      }
+      inc_iter (i, j) = iter;
+      cur_img (i, j)  = color_lut[iter];
+    }
+
+  monitoring_end_tile (x, y, width, height, cpu);
+
+  return recomputed;
+}
+
+unsigned mandel_compute_omp_incremental (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    const int full      = (inc_frame % INCREMENTAL_REFRESH == 0);
+    unsigned recomputed = 0;
+
+    #pragma omp parallel for schedule(runtime) collapse(2) reduction(+ : recomputed)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        recomputed += incremental_tile (x, y, TILE_W, TILE_H, full,
+                                        omp_get_thread_num ());
+
+    PRINT_DEBUG ('u', "Frame %u: %.2f%% of pixels recomputed\n", inc_frame,
+                 100.0 * recomputed / (DIM * DIM));
+
+    // Remember the viewport the iteration counts belong to
+    unsigned *tmp  = inc_prev_iters;
+    inc_prev_iters = inc_iters;
+    inc_iters      = tmp;
+    prev_leftX     = leftX;
+    prev_topY      = topY;
+    prev_xstep     = xstep;
+    prev_ystep     = ystep;
+    inc_frame++;
+
+    zoom ();
+  }
+
+  return 0;
 }
 
 
@@ -234,14 +459,8 @@ int mandel_do_tile_avx (int x, int y, int width, int height)
         zi       = y;
       }
 
-      cur_img (i, j + 0) = iteration_to_color (_mm256_extract_epi32 (iter, 0));
-      cur_img (i, j + 1) = iteration_to_color (_mm256_extract_epi32 (iter, 1));
-      cur_img (i, j + 2) = iteration_to_color (_mm256_extract_epi32 (iter, 2));
-      cur_img (i, j + 3) = iteration_to_color (_mm256_extract_epi32 (iter, 3));
-      cur_img (i, j + 4) = iteration_to_color (_mm256_extract_epi32 (iter, 4));
-      cur_img (i, j + 5) = iteration_to_color (_mm256_extract_epi32 (iter, 5));
-      cur_img (i, j + 6) = iteration_to_color (_mm256_extract_epi32 (iter, 6));
-      cur_img (i, j + 7) = iteration_to_color (_mm256_extract_epi32 (iter, 7));
+      _mm256_storeu_si256 ((__m256i *)&cur_img (i, j),
+                           _mm256_i32gather_epi32 ((int *)color_lut, iter, 4));
     }
 
   return 0;
@@ -249,6 +468,372 @@ int mandel_do_tile_avx (int x, int y, int width, int height)
 
 #endif // AVX
 
+#if __AVX512F__ == 1
+
+void mandel_tile_check_avx512 (void)
+{
+  // Tile width must be larger than AVX-512 vector size
+  easypap_vec_check (AVX512_VEC_SIZE_FLOAT, DIR_HORIZONTAL);
+}
+
+// Row of each pixel index within a tile (computed in double precision so
+// that the division is exact even for huge tiles)
+static inline __m512i tile_row (__m512i idx, __m512d inv_width)
+{
+  const __m512d half = _mm512_set1_pd (0.5);
+  __m512d lo = _mm512_cvtepi32_pd (_mm512_castsi512_si256 (idx));
+  __m512d hi = _mm512_cvtepi32_pd (_mm512_extracti64x4_epi64 (idx, 1));
+
+  lo = _mm512_mul_pd (_mm512_add_pd (lo, half), inv_width);
+  hi = _mm512_mul_pd (_mm512_add_pd (hi, half), inv_width);
+
+  return _mm512_inserti64x4 (
+      _mm512_castsi256_si512 (_mm512_cvttpd_epi32 (lo)),
+      _mm512_cvttpd_epi32 (hi), 1);
+}
+
+// Each lane works on its own pixel: as soon as a lane is done (|Z| > 2 or
+// MAX_ITERATIONS reached), its color is scattered into the image and the lane
+// is refilled with the next pixel of the tile. Lanes thus never wait for the
+// slowest pixel of their vector.
+int mandel_do_tile_avx512 (int x, int y, int width, int height)
+{
+  const __m512i lane =
+      _mm512_set_epi32 (15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const __m512i zero      = _mm512_setzero_si512 ();
+  const __m512i un        = _mm512_set1_epi32 (1);
+  const __m512i max_iter  = _mm512_set1_epi32 (MAX_ITERATIONS);
+  const __m512i total     = _mm512_set1_epi32 (width * height);
+  const __m512i vwidth    = _mm512_set1_epi32 (width);
+  const __m512i vdim      = _mm512_set1_epi32 (DIM);
+  const __m512i origin    = _mm512_set1_epi32 (y * DIM + x);
+  const __m512d inv_width = _mm512_set1_pd (1.0 / width);
+  const __m512 deux       = _mm512_set1_ps (2.0);
+  const __m512 max_norm   = _mm512_set1_ps (4.0);
+
+  __m512i idx    = lane; // pixel index within the tile
+  __m512i iter   = zero;
+  __m512i offset = zero; // pixel offset within the image
+  __m512 zr = _mm512_setzero_ps (), zi = _mm512_setzero_ps ();
+  __m512 cr = zr, ci = zr;
+  int next  = AVX512_VEC_SIZE_FLOAT;
+
+  __mmask16 active = _mm512_cmplt_epi32_mask (idx, total);
+  __mmask16 fresh  = active;
+
+  while (active) {
+    if (fresh) {
+      // Start computing new pixels in the refilled lanes
+      __m512i row = tile_row (idx, inv_width);
+      __m512i col = _mm512_sub_epi32 (idx, _mm512_mullo_epi32 (row, vwidth));
+      __m512i i   = _mm512_add_epi32 (row, _mm512_set1_epi32 (y));
+      __m512i j   = _mm512_add_epi32 (col, _mm512_set1_epi32 (x));
+
+      offset = _mm512_mask_add_epi32 (
+          offset, fresh, origin,
+          _mm512_add_epi32 (_mm512_mullo_epi32 (row, vdim), col));
+      cr = _mm512_mask_mov_ps (
+          cr, fresh,
+          _mm512_fmadd_ps (_mm512_cvtepi32_ps (j), _mm512_set1_ps (xstep),
+                           _mm512_set1_ps (leftX)));
+      ci = _mm512_mask_mov_ps (
+          ci, fresh,
+          _mm512_fnmadd_ps (_mm512_cvtepi32_ps (i), _mm512_set1_ps (ystep),
+                            _mm512_set1_ps (topY)));
+      zr   = _mm512_mask_mov_ps (zr, fresh, _mm512_setzero_ps ());
+      zi   = _mm512_mask_mov_ps (zi, fresh, _mm512_setzero_ps ());
+      iter = _mm512_mask_mov_epi32 (iter, fresh, zero);
+    }
+
+    __m512 rc   = _mm512_mul_ps (zr, zr);
+    __m512 norm = _mm512_fmadd_ps (zi, zi, rc);
+
+    __mmask16 done =
+        _mm512_mask_cmp_ps_mask (active, norm, max_norm, _CMP_GT_OS) |
+        _mm512_mask_cmpeq_epi32_mask (active, iter, max_iter);
+
+    if (done) {
+      __m512i color =
+          _mm512_mask_i32gather_epi32 (zero, done, iter, color_lut, 4);
+      _mm512_mask_i32scatter_epi32 (&cur_img (0, 0), done, offset, color, 4);
+
+      // Give the next pixels of the tile to the lanes which are done
+      idx = _mm512_mask_expand_epi32 (
+          idx, done, _mm512_add_epi32 (_mm512_set1_epi32 (next), lane));
+      next += _mm_popcnt_u32 (done);
+
+      active = _mm512_cmplt_epi32_mask (idx, total);
+      fresh  = done & active;
+      // Fresh lanes have Z = 0 and first go through the fresh block above
+      continue;
+    }
+    fresh = 0;
+
+    // Z = Z^2 + C
+    __m512 nzr = _mm512_add_ps (rc, _mm512_fnmadd_ps (zi, zi, cr));
+    __m512 nzi = _mm512_fmadd_ps (deux, _mm512_mul_ps (zr, zi), ci);
+    zr         = nzr;
+    zi         = nzi;
+    iter       = _mm512_add_epi32 (iter, un);
+  }
+
+  return 0;
+}
+
+#endif // AVX512
+
 #endif
 ///////////////////////////////////////////////////////////////////////////
 
+
+///////////////////////////// Deep zoom with perturbation (deep, omp_deep)
+// Suggested cmdline:
+// DEEP_SCALE=1e-30 ./run -k mandel -v omp_deep -ts 32
+//
+// Floats cannot tell neighbouring pixels apart once the view gets narrower
+// than ~1e-6. Here, one reference orbit Z_n is computed per frame at the
+// center of the view using __float128 (~34 significant digits). Each pixel
+// c = C + dc then only iterates the delta d_n = z_n - Z_n in double precision:
+//   d_{n+1} = 2 Z_n d_n + d_n^2 + dc
+// When |z_n| becomes smaller than |d_n| (glitch: d_n has lost all precision
+// relative to z_n), or when the reference orbit escapes, the pixel rebases
+// onto the start of the reference orbit: d_n = z_n and n = 0.
+//
+// By default, the view is the viewport of the other variants and follows
+// zoom (), so that frames can be compared with seq ones. Setting DEEP_SCALE
+// turns the variants into a separate benchmark: the view is then centered on
+// a point of the boundary of the set (the viewport center lies outside of it,
+// so deep views of it are uniform), with an initial width of DEEP_SCALE.
+// Frames still follow the zoom () steps.
+//
+// Deltas are doubles rather than floats: at a depth of 1e-30, d_n^2 would
+// underflow in single precision. With AVX2, pixels are processed four at a
+// time, each lane following its own position in the reference orbit.
+
+// Seahorse valley, used as center when DEEP_SCALE is set
+#define DEEP_TARGET_X -0.743643887037158704752191506114774Q
+#define DEEP_TARGET_Y 0.131825904205311970493132056385139Q
+
+static __float128 deep_cx, deep_cy;
+static double deep_scale = 1.0; // view width / viewport width
+static double deep_step;
+
+static double *ref_r = NULL, *ref_i = NULL;
+static int ref_len   = 0;
+
+void mandel_init_deep (void)
+{
+  char *str = getenv ("DEEP_SCALE");
+
+  mandel_init ();
+
+  deep_cx = ((__float128)leftX + (__float128)rightX) / 2;
+  deep_cy = ((__float128)topY + (__float128)bottomY) / 2;
+
+  if (str != NULL) {
+    const double width = atof (str);
+
+    if (width <= 0.0)
+      exit_with_error ("DEEP_SCALE must be a positive number (%s)", str);
+    deep_scale = width / (rightX - leftX);
+    deep_cx    = DEEP_TARGET_X;
+    deep_cy    = DEEP_TARGET_Y;
+  }
+
+  ref_r = malloc ((MAX_ITERATIONS + 1) * sizeof (double));
+  ref_i = malloc ((MAX_ITERATIONS + 1) * sizeof (double));
+
+  PRINT_DEBUG ('u', "Deep zoom: initial view width %g\n",
+               deep_scale * (rightX - leftX));
+}
+
+void mandel_finalize_deep (void)
+{
+  free (ref_r);
+  free (ref_i);
+}
+
+void mandel_init_omp_deep (void)
+{
+  mandel_init_deep ();
+}
+
+void mandel_finalize_omp_deep (void)
+{
+  mandel_finalize_deep ();
+}
+
+static void reference_orbit (void)
+{
+  __float128 zr = 0, zi = 0;
+
+  deep_step = deep_scale * (rightX - leftX) / DIM;
+
+  for (ref_len = 0; ref_len < MAX_ITERATIONS; ref_len++) {
+    ref_r[ref_len] = (double)zr;
+    ref_i[ref_len] = (double)zi;
+
+    if (zr * zr + zi * zi > 4)
+      break;
+
+    __float128 twoxy = 2 * zr * zi;
+    zr               = zr * zr - zi * zi + deep_cx;
+    zi               = twoxy + deep_cy;
+  }
+  ref_r[ref_len] = (double)zr;
+  ref_i[ref_len] = (double)zi;
+}
+
+static unsigned deep_one_pixel (int i, int j)
+{
+  const int half   = DIM / 2; // DIM is unsigned
+  const double dcr = (j - half) * deep_step;
+  const double dci = (half - i) * deep_step;
+  double dr = 0.0, di = 0.0;
+  int n = 0, iter;
+
+  for (iter = 0; iter < MAX_ITERATIONS; iter++) {
+    const double zr   = ref_r[n] + dr;
+    const double zi   = ref_i[n] + di;
+    const double norm = zr * zr + zi * zi;
+
+    if (norm > 4.0)
+      break;
+
+    // Rebasing
+    if (norm < dr * dr + di * di || n == ref_len) {
+      dr = zr;
+      di = zi;
+      n  = 0;
+    }
+
+    const double tr = 2.0 * (ref_r[n] * dr - ref_i[n] * di) + dr * dr - di * di;
+    const double ti = 2.0 * (ref_r[n] * di + ref_i[n] * dr) + 2.0 * dr * di;
+
+    dr = tr + dcr;
+    di = ti + dci;
+    n++;
+  }
+
+  return color_lut[iter];
+}
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+
+// Same as deep_one_pixel, on pixels (i, j) to (i, j + 3)
+static void deep_four_pixels (int i, int j)
+{
+  const int half     = DIM / 2;
+  const __m256d four = _mm256_set1_pd (4.0);
+  const __m256d two  = _mm256_set1_pd (2.0);
+  const __m256d dcr  = _mm256_mul_pd (
+      _mm256_add_pd (_mm256_set1_pd (j - half), _mm256_set_pd (3, 2, 1, 0)),
+      _mm256_set1_pd (deep_step));
+  const __m256d dci = _mm256_set1_pd ((half - i) * deep_step);
+  const __m128i len = _mm_set1_epi32 (ref_len);
+  const __m128i one = _mm_set1_epi32 (1);
+  __m256d dr = _mm256_setzero_pd (), di = _mm256_setzero_pd ();
+  __m128i n = _mm_setzero_si128 (), iter = _mm_setzero_si128 ();
+
+  for (int it = 0; it < MAX_ITERATIONS; it++) {
+    __m256d rr   = _mm256_i32gather_pd (ref_r, n, 8);
+    __m256d ri   = _mm256_i32gather_pd (ref_i, n, 8);
+    __m256d zr   = _mm256_add_pd (rr, dr);
+    __m256d zi   = _mm256_add_pd (ri, di);
+    __m256d norm = _mm256_add_pd (_mm256_mul_pd (zr, zr), _mm256_mul_pd (zi, zi));
+
+    // Lanes which have not escaped yet (escaped lanes are frozen)
+    __m256d live = _mm256_cmp_pd (norm, four, _CMP_LE_OQ);
+    if (_mm256_movemask_pd (live) == 0)
+      break;
+    __m128i live32 = _mm256_castsi256_si128 (_mm256_permutevar8x32_epi32 (
+        _mm256_castpd_si256 (live), _mm256_set_epi32 (0, 0, 0, 0, 6, 4, 2, 0)));
+
+    iter = _mm_add_epi32 (iter, _mm_and_si128 (live32, one));
+
+    // Rebasing
+    __m256d dnorm  = _mm256_add_pd (_mm256_mul_pd (dr, dr), _mm256_mul_pd (di, di));
+    __m256d rebase = _mm256_or_pd (
+        _mm256_cmp_pd (norm, dnorm, _CMP_LT_OQ),
+        _mm256_castsi256_pd (_mm256_cvtepi32_epi64 (_mm_cmpeq_epi32 (n, len))));
+    __m128i rebase32 = _mm256_castsi256_si128 (_mm256_permutevar8x32_epi32 (
+        _mm256_castpd_si256 (rebase), _mm256_set_epi32 (0, 0, 0, 0, 6, 4, 2, 0)));
+
+    dr = _mm256_blendv_pd (dr, zr, rebase);
+    di = _mm256_blendv_pd (di, zi, rebase);
+    rr = _mm256_blendv_pd (rr, _mm256_setzero_pd (), rebase); // Z_0 = 0
+    ri = _mm256_blendv_pd (ri, _mm256_setzero_pd (), rebase);
+    n  = _mm_andnot_si128 (rebase32, n);
+
+    __m256d tr = _mm256_sub_pd (
+        _mm256_add_pd (
+            _mm256_mul_pd (two, _mm256_sub_pd (_mm256_mul_pd (rr, dr),
+                                               _mm256_mul_pd (ri, di))),
+            _mm256_mul_pd (dr, dr)),
+        _mm256_mul_pd (di, di));
+    __m256d ti = _mm256_add_pd (
+        _mm256_mul_pd (two, _mm256_add_pd (_mm256_mul_pd (rr, di),
+                                           _mm256_mul_pd (ri, dr))),
+        _mm256_mul_pd (two, _mm256_mul_pd (dr, di)));
+
+    dr = _mm256_blendv_pd (dr, _mm256_add_pd (tr, dcr), live);
+    di = _mm256_blendv_pd (di, _mm256_add_pd (ti, dci), live);
+    n  = _mm_add_epi32 (n, _mm_and_si128 (live32, one));
+  }
+
+  _mm_storeu_si128 ((__m128i *)&cur_img (i, j),
+                    _mm_i32gather_epi32 ((int *)color_lut, iter, 4));
+}
+
+#endif
+
+static void deep_tile (int x, int y, int width, int height, int cpu)
+{
+  monitoring_start_tile (cpu);
+
+  for (int i = y; i < y + height; i++) {
+    int j = x;
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+    for (; j + 4 <= x + width; j += 4)
+      deep_four_pixels (i, j);
+#endif
+    for (; j < x + width; j++)
+      cur_img (i, j) = deep_one_pixel (i, j);
+  }
+
+  monitoring_end_tile (x, y, width, height, cpu);
+}
+
+unsigned mandel_compute_deep (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    reference_orbit ();
+
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        deep_tile (x, y, TILE_W, TILE_H, 0);
+
+    zoom ();
+  }
+
+  return 0;
+}
+
+unsigned mandel_compute_omp_deep (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    reference_orbit ();
+
+    #pragma omp parallel for schedule(runtime) collapse(2)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        deep_tile (x, y, TILE_W, TILE_H, omp_get_thread_num ());
+
+    zoom ();
+  }
+
+  return 0;
+}
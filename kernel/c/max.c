@@ -385,4 +385,385 @@ unsigned max_compute_task (unsigned nb_iter)
   }
 
   return res;
-}
\ No newline at end of file
+}
+///////////////////////////// Task graph version using our scheduler (sched)
+// Suggested cmdline(s):
+// ./run -l images/spirale.png -k max -v sched -ts 32 -t
+//
+static task_handle_t *handles = NULL;
+static int sched_change       = 0;
+
+void max_init_sched (void)
+{
+  max_init ();
+
+  handles = malloc (NB_TILES_X * NB_TILES_Y * sizeof (task_handle_t));
+
+  scheduler_init (-1);
+}
+
+void max_finalize_sched (void)
+{
+  scheduler_finalize ();
+
+  free (handles);
+}
+
+static void down_right_task (void *p, unsigned cpu)
+{
+  const unsigned tile = (uintptr_t)p;
+  const int i = tile / NB_TILES_X, j = tile % NB_TILES_X;
+
+  if (tile_down_right (j * TILE_W, i * TILE_H, TILE_W, TILE_H, cpu))
+    __atomic_store_n (&sched_change, 1, __ATOMIC_RELAXED);
+}
+
+static void up_left_task (void *p, unsigned cpu)
+{
+  const unsigned tile = (uintptr_t)p;
+  const int i = tile / NB_TILES_X, j = tile % NB_TILES_X;
+
+  if (tile_up_left (j * TILE_W, i * TILE_H, TILE_W, TILE_H, cpu))
+    __atomic_store_n (&sched_change, 1, __ATOMIC_RELAXED);
+}
+
+#define handle(i, j) handles[(i) * NB_TILES_X + (j)]
+
+unsigned max_compute_sched (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    sched_change = 0;
+
+    // Bottom-right propagation
+    for (int i = 0; i < NB_TILES_Y; i++)
+      for (int j = 0; j < NB_TILES_X; j++) {
+        task_handle_t deps[2] = {i > 0 ? handle (i - 1, j) : NULL,
+                                 j > 0 ? handle (i, j - 1) : NULL};
+
+        handle (i, j) = scheduler_create_task_dep (
+            down_right_task, (void *)(uintptr_t)(i * NB_TILES_X + j), -1,
+            deps, 2);
+      }
+
+    // Up-left propagation: the last down-right task depends on all others,
+    // so we do not need to wait for the whole first wave
+    task_handle_t last = handle (NB_TILES_Y - 1, NB_TILES_X - 1);
+
+    for (int i = NB_TILES_Y - 1; i >= 0; i--)
+      for (int j = NB_TILES_X - 1; j >= 0; j--) {
+        task_handle_t deps[3] = {
+            i < NB_TILES_Y - 1 ? handle (i + 1, j) : NULL,
+            j < NB_TILES_X - 1 ? handle (i, j + 1) : NULL,
+            (i == NB_TILES_Y - 1 && j == NB_TILES_X - 1) ? last : NULL};
+
+        handle (i, j) = scheduler_create_task_dep (
+            up_left_task, (void *)(uintptr_t)(i * NB_TILES_X + j), -1, deps,
+            3);
+      }
+
+    scheduler_task_wait ();
+
+    if (!sched_change) {
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+///////////////////////////// Lazy tiles (shared by omp_wavefront and omp_counter)
+// A tile is skipped when neither itself nor one of its 4 neighbours changed
+// since it was last processed: its inputs are the same, so running it again
+// would not change anything. next_changed is filled as tiles are processed
+// during the current iteration, last_changed holds the previous iteration.
+
+static unsigned char *_last_changed = NULL, *_next_changed = NULL;
+
+#define last_changed(i, j) _last_changed[(i) * NB_TILES_X + (j)]
+#define next_changed(i, j) _next_changed[(i) * NB_TILES_X + (j)]
+
+static void lazy_init (void)
+{
+  max_init ();
+
+  _last_changed = malloc (NB_TILES_X * NB_TILES_Y);
+  _next_changed = malloc (NB_TILES_X * NB_TILES_Y);
+
+  // Every tile must be processed during the first iteration
+  memset (_last_changed, 1, NB_TILES_X * NB_TILES_Y);
+}
+
+static void lazy_finalize (void)
+{
+  free (_last_changed);
+  free (_next_changed);
+}
+
+static inline void lazy_swap (void)
+{
+  unsigned char *tmp = _last_changed;
+
+  _last_changed = _next_changed;
+  _next_changed = tmp;
+}
+
+static inline int neighbour_changed (unsigned char *changed, int i, int j)
+{
+  return changed[i * NB_TILES_X + j] ||
+         (i > 0 && changed[(i - 1) * NB_TILES_X + j]) ||
+         (i < NB_TILES_Y - 1 && changed[(i + 1) * NB_TILES_X + j]) ||
+         (j > 0 && changed[i * NB_TILES_X + j - 1]) ||
+         (j < NB_TILES_X - 1 && changed[i * NB_TILES_X + j + 1]);
+}
+
+// Down-right pass: up and left neighbours were processed just before
+static int lazy_down_right (int i, int j, int cpu)
+{
+  int change = 0;
+
+  if (neighbour_changed (_last_changed, i, j) ||
+      (i > 0 && next_changed (i - 1, j)) || (j > 0 && next_changed (i, j - 1)))
+    change = tile_down_right (j * TILE_W, i * TILE_H, TILE_W, TILE_H, cpu);
+
+  next_changed (i, j) = change;
+
+  return change;
+}
+
+// Up-left pass: down and right neighbours were processed just before
+static int lazy_up_left (int i, int j, int cpu)
+{
+  int change = 0;
+
+  if (neighbour_changed (_last_changed, i, j) ||
+      neighbour_changed (_next_changed, i, j))
+    change = tile_up_left (j * TILE_W, i * TILE_H, TILE_W, TILE_H, cpu);
+
+  next_changed (i, j) |= change;
+
+  return change;
+}
+
+///////////////////////////// Wavefront version (omp_wavefront)
+// Suggested cmdline(s):
+// ./run -l images/spirale.png -k max -v omp_wavefront -ts 32 -m
+//
+// Tile (i, j) only depends on tiles (i - 1, j) and (i, j - 1) during the
+// down-right pass (and (i + 1, j), (i, j + 1) during the up-left one), so
+// all tiles of an anti-diagonal can be processed in parallel.
+
+void max_init_omp_wavefront (void)
+{
+  lazy_init ();
+}
+
+void max_finalize_omp_wavefront (void)
+{
+  lazy_finalize ();
+}
+
+unsigned max_compute_omp_wavefront (unsigned nb_iter)
+{
+  const int nb_x = NB_TILES_X, nb_y = NB_TILES_Y;
+  const int nb_diags = nb_x + nb_y - 1;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    #pragma omp parallel
+    {
+      // Down-right propagation
+      for (int d = 0; d < nb_diags; d++)
+        #pragma omp for schedule(runtime) reduction(| : change)
+        for (int i = max (0, d - nb_x + 1); i <= min (d, nb_y - 1); i++)
+          change |= lazy_down_right (i, d - i, omp_get_thread_num ());
+
+      // Up-left propagation
+      for (int d = nb_diags - 1; d >= 0; d--)
+        #pragma omp for schedule(runtime) reduction(| : change)
+        for (int i = max (0, d - nb_x + 1); i <= min (d, nb_y - 1); i++)
+          change |= lazy_up_left (i, d - i, omp_get_thread_num ());
+    }
+
+    lazy_swap ();
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Tasks with dependency counters (omp_counter)
+// Suggested cmdline(s):
+// ./run -l images/spirale.png -k max -v omp_counter -ts 32 -m
+//
+// Instead of OpenMP depend clauses, each tile holds the number of tasks it
+// still waits for. The task which brings a counter down to zero spawns the
+// corresponding tile task. The last down-right task spawns the first up-left
+// one.
+
+static int *_counters = NULL;
+static int counter_change = 0;
+
+#define counter(i, j) _counters[(i) * NB_TILES_X + (j)]
+
+void max_init_omp_counter (void)
+{
+  lazy_init ();
+
+  _counters = malloc (NB_TILES_X * NB_TILES_Y * sizeof (int));
+}
+
+void max_finalize_omp_counter (void)
+{
+  free (_counters);
+
+  lazy_finalize ();
+}
+
+static inline int counter_release (int i, int j)
+{
+  return __atomic_sub_fetch (&counter (i, j), 1, __ATOMIC_ACQ_REL) == 0;
+}
+
+static void up_left_counter_task (int i, int j)
+{
+  if (lazy_up_left (i, j, omp_get_thread_num ()))
+    __atomic_store_n (&counter_change, 1, __ATOMIC_RELAXED);
+
+  if (i > 0 && counter_release (i - 1, j))
+    #pragma omp task firstprivate(i, j)
+    up_left_counter_task (i - 1, j);
+
+  if (j > 0 && counter_release (i, j - 1))
+    #pragma omp task firstprivate(i, j)
+    up_left_counter_task (i, j - 1);
+}
+
+static void down_right_counter_task (int i, int j)
+{
+  if (lazy_down_right (i, j, omp_get_thread_num ()))
+    __atomic_store_n (&counter_change, 1, __ATOMIC_RELAXED);
+
+  // Counters are reset for the up-left pass once they reach zero
+  counter (i, j) = (i < NB_TILES_Y - 1) + (j < NB_TILES_X - 1);
+
+  if (i == NB_TILES_Y - 1 && j == NB_TILES_X - 1)
+    up_left_counter_task (i, j);
+
+  if (i < NB_TILES_Y - 1 && counter_release (i + 1, j))
+    #pragma omp task firstprivate(i, j)
+    down_right_counter_task (i + 1, j);
+
+  if (j < NB_TILES_X - 1 && counter_release (i, j + 1))
+    #pragma omp task firstprivate(i, j)
+    down_right_counter_task (i, j + 1);
+}
+
+unsigned max_compute_omp_counter (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    counter_change = 0;
+
+    for (int i = 0; i < NB_TILES_Y; i++)
+      for (int j = 0; j < NB_TILES_X; j++)
+        counter (i, j) = (i > 0) + (j > 0);
+
+    #pragma omp taskgroup
+    down_right_counter_task (0, 0);
+
+    lazy_swap ();
+
+    if (!counter_change) {
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+///////////////////////////// OpenCL version (ocl)
+// Suggested cmdline(s):
+// ./run -l images/spirale.png -k max -g -v ocl
+//
+// Each work-group propagates colors inside its tile until local convergence
+// (see kernel/ocl/max.cl). The kernel raises changed[slot] when some pixel was
+// modified during the slot-th iteration of a batch, and we read these flags
+// back once every MAX_OCL_BATCH iterations: further iterations leave a stable
+// image untouched, so the stabilization iteration is still exact.
+
+#define MAX_OCL_BATCH 32
+
+static cl_mem changed_buffer = 0;
+
+void max_init_ocl (void)
+{
+  max_init ();
+
+  changed_buffer = clCreateBuffer (context, CL_MEM_READ_WRITE,
+                                   MAX_OCL_BATCH * sizeof (unsigned), NULL,
+                                   NULL);
+  if (!changed_buffer)
+    exit_with_error ("Failed to allocate changed_buffer");
+}
+
+void max_finalize_ocl (void)
+{
+  clReleaseMemObject (changed_buffer);
+}
+
+unsigned max_invoke_ocl (unsigned nb_iter)
+{
+  size_t global[2] = {GPU_SIZE_X, GPU_SIZE_Y};
+  size_t local[2]  = {GPU_TILE_W, GPU_TILE_H};
+  unsigned flags[MAX_OCL_BATCH];
+  const unsigned zero = 0;
+  unsigned res        = 0;
+  cl_int err;
+
+  monitoring_start_tile (easypap_gpu_lane (TASK_TYPE_COMPUTE));
+
+  for (unsigned it = 1; it <= nb_iter && !res; it += MAX_OCL_BATCH) {
+    const unsigned batch = min (MAX_OCL_BATCH, nb_iter - it + 1);
+
+    err = clEnqueueFillBuffer (queue, changed_buffer, &zero, sizeof (zero), 0,
+                               batch * sizeof (unsigned), 0, NULL, NULL);
+    check (err, "Failed to clear changed_buffer");
+
+    for (unsigned slot = 0; slot < batch; slot++) {
+      err = 0;
+      err |= clSetKernelArg (compute_kernel, 0, sizeof (cl_mem), &cur_buffer);
+      err |= clSetKernelArg (compute_kernel, 1, sizeof (cl_mem),
+                             &changed_buffer);
+      err |= clSetKernelArg (compute_kernel, 2, sizeof (unsigned), &slot);
+      check (err, "Failed to set kernel arguments");
+
+      err = clEnqueueNDRangeKernel (queue, compute_kernel, 2, NULL, global,
+                                    local, 0, NULL, NULL);
+      check (err, "Failed to execute kernel");
+    }
+
+    err = clEnqueueReadBuffer (queue, changed_buffer, CL_TRUE, 0,
+                               batch * sizeof (unsigned), flags, 0, NULL, NULL);
+    check (err, "Failed to read changed_buffer");
+
+    for (unsigned slot = 0; slot < batch; slot++)
+      if (!flags[slot]) {
+        res = it + slot;
+        break;
+      }
+  }
+
+  monitoring_end_tile (0, 0, DIM, DIM, easypap_gpu_lane (TASK_TYPE_COMPUTE));
+
+  return res;
+}
@@ -2,6 +2,13 @@
 #include "easypap.h"
 
 #include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+#include <immintrin.h>
+#endif
 
 static unsigned PIX_BLOC = 16;
 static unsigned LOG_BLOC = 4; // LOG2(PIX_BLOC)
@@ -87,6 +94,205 @@ unsigned pixelize_compute_seq (unsigned nb_iter)
 }
 
 
+///////////////////////////// Summed-area table versions (sat, omp_tiled_sat)
+// Suggested cmdline(s):
+// ./run -l images/1024.png -k pixelize -v sat -a 24x10
+// ./run -l images/1024.png -k pixelize -v omp_tiled_sat -ts 64 -a 12 -m
+//
+// A summed-area table of the four channels is built once per frame, so that
+// the sum of any block is obtained from four cells of the table. Blocks may
+// thus have any size (--arg N or WxH), and blocks crossing the right or bottom
+// border of the image are truncated. Only the rows of the table lying on
+// block boundaries are kept: the table is much smaller than the image and
+// building it costs a single read of the image. Sums are computed modulo
+// 2^32, which remains exact as long as a single block sums to less than 2^32.
+
+static int BLOC_W = 16, BLOC_H = 16;
+static uint32_t *sat = NULL; // sat_rows x (DIM + 1) cells of 4 channels
+static int sat_rows  = 0;
+
+#define SAT_SIZE (sat_rows * (DIM + 1) * 4 * sizeof (uint32_t))
+
+// sat_cell (k, x) holds the sums of the pixels (i, j) with i < k * BLOC_H
+// (or i < DIM for the last row) and j < x
+#define sat_cell(k, x) (sat + ((k) * (DIM + 1) + (x)) * 4)
+
+static void sat_config (char *param)
+{
+  if (param != NULL) {
+    int w = 0, h = 0, end = 0;
+
+    // The whole parameter must be consumed (e.g. "16x" is rejected)
+    if (sscanf (param, "%dx%d%n", &w, &h, &end) != 2 || param[end] != '\0') {
+      end = 0;
+      if (sscanf (param, "%d%n", &w, &end) == 1 && param[end] == '\0')
+        h = w;
+      else
+        w = h = 0;
+    }
+    if (w <= 0 || h <= 0 || w > DIM || h > DIM)
+      exit_with_error ("Block size must be N or WxH, with sizes in [1, DIM] "
+                       "(%s)", param);
+
+    BLOC_W = w;
+    BLOC_H = h;
+  }
+
+  PRINT_DEBUG ('u', "Pixelize blocks: %d x %d\n", BLOC_W, BLOC_H);
+}
+
+static void sat_init (void)
+{
+  sat_rows = (DIM + BLOC_H - 1) / BLOC_H + 1;
+
+  // Row 0 is never written and remains zero (the table is zero-filled)
+  sat = vec_huge_malloc (SAT_SIZE);
+  if (sat == NULL)
+    exit_with_error ("Cannot allocate summed-area table");
+}
+
+static void sat_finalize (void)
+{
+  vec_huge_free (sat, SAT_SIZE);
+}
+
+// Row k + 1 of the table first receives the sums of the pixels of block row
+// k only. Channel c of a cell holds the sums of byte c of the pixels.
+static void sat_strip (int k)
+{
+  uint32_t *restrict s = sat_cell (k + 1, 0);
+  const int i_end      = min ((k + 1) * BLOC_H, (int)DIM);
+
+  memset (s, 0, (DIM + 1) * 4 * sizeof (uint32_t));
+
+  // Stores into s may alias DIM, so loop bounds are kept in locals
+  for (int i = k * BLOC_H; i < i_end; i++) {
+    const uint32_t *restrict row = &cur_img (i, 0);
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+    __m128i *restrict cell = (__m128i *)s;
+    __m128i sum            = _mm_setzero_si128 ();
+
+    for (int j = 1, dim = DIM; j <= dim; j++) {
+      // One byte of the pixel per 32-bit lane
+      sum = _mm_add_epi32 (sum,
+                           _mm_cvtepu8_epi32 (_mm_cvtsi32_si128 (row[j - 1])));
+      _mm_storeu_si128 (cell + j,
+                        _mm_add_epi32 (_mm_loadu_si128 (cell + j), sum));
+    }
+#else
+    uint32_t sum[4] = {0, 0, 0, 0};
+
+    for (int j = 1, dim = DIM; j <= dim; j++)
+      for (int c = 0; c < 4; c++)
+        s[4 * j + c] += sum[c] += (row[j - 1] >> (8 * c)) & 255;
+#endif
+  }
+}
+
+static void sat_build (int parallel)
+{
+  #pragma omp parallel for schedule(static) if (parallel)
+  for (int k = 0; k < sat_rows - 1; k++)
+    sat_strip (k);
+
+  // Strips are accumulated downwards
+  for (int k = 2; k < sat_rows; k++) {
+    uint32_t *restrict s = sat_cell (k, 0), *restrict up = sat_cell (k - 1, 0);
+
+    for (int n = 0; n < (DIM + 1) * 4; n++)
+      s[n] += up[n];
+  }
+}
+
+// Fills the part of each block lying within the tile with the block mean
+static void sat_tile (int x, int y, int width, int height)
+{
+  for (int by = y - y % BLOC_H; by < y + height; by += BLOC_H)
+    for (int bx = x - x % BLOC_W; bx < x + width; bx += BLOC_W) {
+      const int bx1 = min (bx + BLOC_W, (int)DIM);
+      const int by1 = min (by + BLOC_H, (int)DIM);
+      const int k   = by / BLOC_H;
+      const uint32_t n = (bx1 - bx) * (by1 - by);
+      uint32_t *tl = sat_cell (k, bx), *tr = sat_cell (k, bx1);
+      uint32_t *bl = sat_cell (k + 1, bx), *br = sat_cell (k + 1, bx1);
+      unsigned mean = 0;
+
+      for (int c = 0; c < 4; c++)
+        mean |= ((br[c] - tr[c] - bl[c] + tl[c]) / n) << (8 * c);
+
+      for (int i = max (by, y); i < min (by1, y + height); i++)
+        for (int j = max (bx, x); j < min (bx1, x + width); j++)
+          cur_img (i, j) = mean;
+    }
+}
+
+void pixelize_config_sat (char *param)
+{
+  sat_config (param);
+}
+
+void pixelize_init_sat (void)
+{
+  sat_init ();
+}
+
+void pixelize_finalize_sat (void)
+{
+  sat_finalize ();
+}
+
+unsigned pixelize_compute_sat (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    sat_build (0);
+
+    monitoring_start_tile (0);
+
+    sat_tile (0, 0, DIM, DIM);
+
+    monitoring_end_tile (0, 0, DIM, DIM, 0);
+  }
+
+  return 0;
+}
+
+void pixelize_config_omp_tiled_sat (char *param)
+{
+  sat_config (param);
+}
+
+void pixelize_init_omp_tiled_sat (void)
+{
+  sat_init ();
+}
+
+void pixelize_finalize_omp_tiled_sat (void)
+{
+  sat_finalize ();
+}
+
+unsigned pixelize_compute_omp_tiled_sat (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    sat_build (1);
+
+    #pragma omp parallel for schedule(runtime) collapse(2)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W) {
+        monitoring_start_tile (omp_get_thread_num ());
+
+        sat_tile (x, y, TILE_W, TILE_H);
+
+        monitoring_end_tile (x, y, TILE_W, TILE_H, omp_get_thread_num ());
+      }
+  }
+
+  return 0;
+}
+
 ///////////////////////////// OpenCL big variant (ocl_big)
 
 unsigned pixelize_invoke_ocl (unsigned nb_iter)
@@ -140,3 +346,81 @@ void pixelize_init_ocl (void)
     exit_with_error ("Tile size (%d) must be a multiple of PIX_BLOC (%d)",
                      GPU_TILE_W, PIX_BLOC);
 }
+
+///////////////////////////// OpenCL summed-area table variant (ocl_sat)
+// Suggested cmdline:
+// ./run -l images/1024.png -k pixelize -o -v ocl_sat -a 24
+//
+// The kernel is launched four times per iteration: row prefix sums, column
+// prefix sums (each one being a scan inside work-groups followed by a carry
+// pass), then block means. Since --arg is also given to the OpenCL compiler,
+// only square blocks (-a N) are accepted, but N may be any size.
+
+static cl_mem sat_buffer = 0, carry_buffer = 0;
+
+void pixelize_config_ocl_sat (char *param)
+{
+  if (param != NULL && strchr (param, 'x') != NULL)
+    exit_with_error ("ocl_sat only supports square blocks (-a N)");
+
+  sat_config (param);
+}
+
+void pixelize_init_ocl_sat (void)
+{
+  const size_t size = (DIM + 1) * (DIM + 1) * 4 * sizeof (unsigned);
+  // Totals of the row segments, then of the column segments, of the tiles
+  const size_t carry_size =
+      (DIM * (DIM / GPU_TILE_W) + (DIM / GPU_TILE_H) * DIM) * 4 *
+      sizeof (unsigned);
+
+  if (GPU_SIZE_X != DIM || GPU_SIZE_Y != DIM || DIM % GPU_TILE_W ||
+      DIM % GPU_TILE_H)
+    exit_with_error ("ocl_sat needs a DIM x DIM grid of whole tiles");
+
+  sat_buffer = clCreateBuffer (context, CL_MEM_READ_WRITE, size, NULL, NULL);
+  if (!sat_buffer)
+    exit_with_error ("Failed to allocate summed-area table buffer");
+
+  carry_buffer =
+      clCreateBuffer (context, CL_MEM_READ_WRITE, carry_size, NULL, NULL);
+  if (!carry_buffer)
+    exit_with_error ("Failed to allocate carry buffer");
+}
+
+void pixelize_finalize_ocl_sat (void)
+{
+  clReleaseMemObject (carry_buffer);
+  clReleaseMemObject (sat_buffer);
+}
+
+unsigned pixelize_invoke_ocl_sat (unsigned nb_iter)
+{
+  size_t global[2] = {GPU_SIZE_X, GPU_SIZE_Y};
+  size_t local[2]  = {GPU_TILE_W, GPU_TILE_H};
+  cl_int err;
+
+  monitoring_start_tile (easypap_gpu_lane (TASK_TYPE_COMPUTE));
+
+  for (unsigned it = 1; it <= nb_iter; it++)
+    for (unsigned phase = 0; phase < 4; phase++) {
+      err = 0;
+      err |= clSetKernelArg (compute_kernel, 0, sizeof (cl_mem), &cur_buffer);
+      err |= clSetKernelArg (compute_kernel, 1, sizeof (cl_mem), &sat_buffer);
+      err |= clSetKernelArg (compute_kernel, 2, sizeof (cl_mem), &carry_buffer);
+      err |= clSetKernelArg (compute_kernel, 3, sizeof (unsigned), &phase);
+      err |= clSetKernelArg (compute_kernel, 4, sizeof (int), &BLOC_W);
+      err |= clSetKernelArg (compute_kernel, 5, sizeof (int), &BLOC_H);
+      check (err, "Failed to set kernel arguments");
+
+      err = clEnqueueNDRangeKernel (queue, compute_kernel, 2, NULL, global,
+                                    local, 0, NULL, NULL);
+      check (err, "Failed to execute kernel");
+    }
+
+  clFinish (queue);
+
+  monitoring_end_tile (0, 0, DIM, DIM, easypap_gpu_lane (TASK_TYPE_COMPUTE));
+
+  return 0;
+}
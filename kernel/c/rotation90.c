@@ -1,5 +1,6 @@
 
 #include "easypap.h"
+#include "transpose_block.h"
 
 #include <omp.h>
 #include <stdbool.h>
@@ -14,6 +15,32 @@ int rotation90_do_tile_default (int x, int y, int width, int height)
   return 0;
 }
 
+///////////////////////////// Blocked tiling (avx2)
+// Suggested cmdline:
+// ./run -l images/shibuya.png -k rotation90 -v omp_tiled -wt avx2 -ts 64
+//
+// A rotation is a transposition writing destination rows in reverse order:
+// the transpose micro-kernels are used with a negative destination stride
+int rotation90_do_tile_avx2 (int x, int y, int width, int height)
+{
+  transpose_block (&next_img (DIM - y - 1, x), -DIM, &cur_img (x, y), DIM,
+                   width, height);
+
+  return 0;
+}
+
+///////////////////////////// Cache-oblivious tiling (rec)
+// Suggested cmdline:
+// ./run -l images/shibuya.png -k rotation90 -v seq -wt rec
+//
+int rotation90_do_tile_rec (int x, int y, int width, int height)
+{
+  transpose_rec (&next_img (DIM - y - 1, x), -DIM, &cur_img (x, y), DIM,
+                 width, height);
+
+  return 0;
+}
+
 ///////////////////////////// Simple sequential version (seq)
 // Suggested cmdline:
 // ./run --load-image images/shibuya.png --kernel rotation90 --pause
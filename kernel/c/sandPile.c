@@ -2,7 +2,7 @@
 
 #include <omp.h>
 #include <stdbool.h>
-#include <sys/mman.h>
+#include <stdint.h>
 #include <unistd.h>
 
 typedef unsigned int TYPE;
@@ -176,6 +176,78 @@ ALIAS(draw_alea);
 ALIAS(draw_big);
 ALIAS(draw_spirals);
 
+///////////////////////////// Active area tracking (frontier variants)
+// For single-source configurations (big, DIM), only a growing diamond around
+// the seeds is active. frontier variants only sweep the tiles intersecting a
+// box enclosing the cells that may topple, and grow the box by one cell
+// around every tile which toppled something. The area of the box is recorded
+// in traces at each sweep.
+
+typedef struct
+{
+  int x0, y0, x1, y1; // [x0, x1[ x [y0, y1[
+} box_t;
+
+static box_t frontier, prev_frontier;
+
+static inline void frontier_reset(void)
+{
+  frontier = prev_frontier = (box_t){1, 1, DIM - 1, DIM - 1};
+}
+
+static inline int box_area(box_t b)
+{
+  return (b.x1 > b.x0 && b.y1 > b.y0) ? (b.x1 - b.x0) * (b.y1 - b.y0) : 0;
+}
+
+static inline box_t box_union(box_t a, box_t b)
+{
+  if (!box_area(a))
+    return b;
+  if (!box_area(b))
+    return a;
+
+  return (box_t){min(a.x0, b.x0), min(a.y0, b.y0), max(a.x1, b.x1),
+                 max(a.y1, b.y1)};
+}
+
+// Sweeps the tiles intersecting the area with do_tile and returns the next
+// frontier. Tiles are visited in the same order as the tiled variants.
+static box_t frontier_sweep(box_t area, int parallel)
+{
+  int x0 = DIM, y0 = DIM, x1 = 0, y1 = 0;
+
+  // easyview displays the number of cells swept when hovering an iteration
+  monitoring_counter(box_area(area));
+
+  if (!box_area(area))
+    return area;
+
+#pragma omp parallel for collapse(2) schedule(runtime) if (parallel)          \
+    reduction(min : x0, y0) reduction(max : x1, y1)
+  for (int ty = area.y0 / TILE_H; ty <= (area.y1 - 1) / TILE_H; ty++)
+    for (int tx = area.x0 / TILE_W; tx <= (area.x1 - 1) / TILE_W; tx++)
+    {
+      const int x = max(tx * TILE_W, area.x0);
+      const int y = max(ty * TILE_H, area.y0);
+      const int w = min((tx + 1) * TILE_W, area.x1) - x;
+      const int h = min((ty + 1) * TILE_H, area.y1) - y;
+
+      if (do_tile(x, y, w, h, omp_get_thread_num()))
+      {
+        x0 = min(x0, x - 1);
+        y0 = min(y0, y - 1);
+        x1 = max(x1, x + w + 1);
+        y1 = max(y1, y + h + 1);
+      }
+    }
+
+  PRINT_DEBUG('m', "Frontier: swept %d cells out of %d\n", box_area(area),
+              (DIM - 2) * (DIM - 2));
+
+  return (box_t){max(x0, 1), max(y0, 1), min(x1, DIM - 1), min(y1, DIM - 1)};
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////// Synchronous Kernel
@@ -184,15 +256,30 @@ ALIAS(draw_spirals);
 
 void ssandPile_init()
 {
-  TABLE = calloc(2 * DIM * DIM, sizeof(TYPE));
+  TABLE = vec_huge_malloc(2 * DIM * DIM * sizeof(TYPE));
+
+  img_data_register_table("table[0]", TABLE, sizeof(TYPE));
+  img_data_register_table("table[1]", TABLE + DIM * DIM, sizeof(TYPE));
 }
 
 void ssandPile_finalize()
 {
-  free(TABLE);
+  vec_huge_free(TABLE, 2 * DIM * DIM * sizeof(TYPE));
 }
 
-int ssandPile_do_tile_default(int x, int y, int width, int height)
+// Cells of the image border form a sink and are never updated: border tiles
+// are shrunk accordingly before being given to the inner tile function
+static inline void clip_border_tile(int *x, int *y, int *width, int *height)
+{
+  const int x1 = min(*x + *width, DIM - 1), y1 = min(*y + *height, DIM - 1);
+
+  *x      = max(*x, 1);
+  *y      = max(*y, 1);
+  *width  = x1 - *x;
+  *height = y1 - *y;
+}
+
+int ssandPile_do_tile_default_inner(int x, int y, int width, int height)
 {
   int diff = 0;
 
@@ -211,6 +298,78 @@ int ssandPile_do_tile_default(int x, int y, int width, int height)
   return diff;
 }
 
+int ssandPile_do_tile_default_border(int x, int y, int width, int height)
+{
+  clip_border_tile(&x, &y, &width, &height);
+
+  return ssandPile_do_tile_default_inner(x, y, width, height);
+}
+
+///////////////////////////// Vectorized tiling (avx2)
+// Suggested cmdline:
+// ./run -k ssandPile -s 2048 -a alea -v omp_tiled -wt avx2
+//
+// Divisions and modulos by 4 become shifts and masks on 8 cells at a time.
+
+#ifdef ENABLE_VECTO
+#include <immintrin.h>
+
+#if __AVX2__ == 1
+
+int ssandPile_do_tile_avx2_inner(int x, int y, int width, int height)
+{
+  const __m256i three = _mm256_set1_epi32(3);
+  __m256i unstable    = _mm256_setzero_si256();
+  int diff            = 0;
+
+  for (int i = y; i < y + height; i++)
+  {
+    int j = x;
+
+    for (; j + AVX_VEC_SIZE_INT <= x + width; j += AVX_VEC_SIZE_INT)
+    {
+      __m256i me = _mm256_loadu_si256((__m256i *)&table(in, i, j));
+      __m256i n  = _mm256_loadu_si256((__m256i *)&table(in, i - 1, j));
+      __m256i s  = _mm256_loadu_si256((__m256i *)&table(in, i + 1, j));
+      __m256i w  = _mm256_loadu_si256((__m256i *)&table(in, i, j - 1));
+      __m256i e  = _mm256_loadu_si256((__m256i *)&table(in, i, j + 1));
+
+      __m256i res = _mm256_add_epi32(
+          _mm256_add_epi32(_mm256_and_si256(me, three),
+                           _mm256_srli_epi32(n, 2)),
+          _mm256_add_epi32(_mm256_add_epi32(_mm256_srli_epi32(s, 2),
+                                            _mm256_srli_epi32(w, 2)),
+                           _mm256_srli_epi32(e, 2)));
+
+      _mm256_storeu_si256((__m256i *)&table(out, i, j), res);
+      // A cell is unstable as soon as one of its bits above 1 is set
+      unstable = _mm256_or_si256(unstable, _mm256_andnot_si256(three, res));
+    }
+
+    for (; j < x + width; j++)
+    {
+      table(out, i, j) = (table(in, i, j) & 3) + (table(in, i + 1, j) >> 2) +
+                         (table(in, i - 1, j) >> 2) +
+                         (table(in, i, j + 1) >> 2) +
+                         (table(in, i, j - 1) >> 2);
+      diff |= table(out, i, j) >= 4;
+    }
+  }
+
+  return diff || !_mm256_testz_si256(unstable, unstable);
+}
+
+int ssandPile_do_tile_avx2_border(int x, int y, int width, int height)
+{
+  clip_border_tile(&x, &y, &width, &height);
+
+  return ssandPile_do_tile_avx2_inner(x, y, width, height);
+}
+
+#endif // AVX2
+
+#endif // ENABLE_VECTO
+
 // Renvoie le nombre d'itérations effectuées avant stabilisation, ou 0
 unsigned ssandPile_compute_seq(unsigned nb_iter)
 {
@@ -232,10 +391,26 @@ unsigned ssandPile_compute_tiled(unsigned nb_iter)
 
     for (int y = 0; y < DIM; y += TILE_H)
       for (int x = 0; x < DIM; x += TILE_W)
-        change |=
-            do_tile(x + (x == 0), y + (y == 0),
-                    TILE_W - ((x + TILE_W == DIM) + (x == 0)),
-                    TILE_H - ((y + TILE_H == DIM) + (y == 0)), 0 /* CPU id */);
+        change |= do_tile(x, y, TILE_W, TILE_H, 0 /* CPU id */);
+    swap_tables();
+    if (change == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// OpenMP tiled version (omp_tiled)
+
+unsigned ssandPile_compute_omp_tiled(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    int change = 0;
+
+#pragma omp parallel for schedule(runtime) reduction(| : change)
+    for (unsigned t = 0; t < NB_TILES_X * NB_TILES_Y; t++)
+      change |= do_tile_border_first(t, omp_get_thread_num());
     swap_tables();
     if (change == 0)
       return it;
@@ -244,6 +419,458 @@ unsigned ssandPile_compute_tiled(unsigned nb_iter)
   return 0;
 }
 
+///////////////////////////// Lazy OpenMP tiled version (omp_tiled_lazy)
+// Suggested cmdline:
+// ./run -k ssandPile -s 4096 -a 4partout -v omp_tiled_lazy -ts 64
+//
+// A tile is only recomputed when itself or one of its 4 neighbours still
+// holds unstable cells at the previous iteration. Because we work with two
+// tables, a tile which has just been computed is copied once into the other
+// table before being left alone, so that both tables hold the same values.
+
+static unsigned char *restrict _last_changed = NULL,
+                               *restrict _next_changed = NULL;
+static unsigned char *restrict _dirty = NULL;
+
+#define last_changed(ty, tx) (_last_changed[(ty) * NB_TILES_X + (tx)])
+#define next_changed(ty, tx) (_next_changed[(ty) * NB_TILES_X + (tx)])
+
+static void lazy_init(void)
+{
+  const unsigned nb_tiles = NB_TILES_X * NB_TILES_Y;
+
+  _last_changed = malloc(nb_tiles);
+  _next_changed = calloc(nb_tiles, 1);
+  _dirty        = calloc(nb_tiles, 1);
+
+  // Every tile must be computed at least once
+  memset(_last_changed, 1, nb_tiles);
+}
+
+static void lazy_finalize(void)
+{
+  free(_last_changed);
+  free(_next_changed);
+  free(_dirty);
+}
+
+static inline void swap_changed(void)
+{
+  unsigned char *tmp = _last_changed;
+
+  _last_changed = _next_changed;
+  _next_changed = tmp;
+}
+
+static inline int tile_needed(int ty, int tx)
+{
+  return last_changed(ty, tx) || (ty > 0 && last_changed(ty - 1, tx)) ||
+         (ty < NB_TILES_Y - 1 && last_changed(ty + 1, tx)) ||
+         (tx > 0 && last_changed(ty, tx - 1)) ||
+         (tx < NB_TILES_X - 1 && last_changed(ty, tx + 1));
+}
+
+void ssandPile_init_omp_tiled_lazy()
+{
+  ssandPile_init();
+  lazy_init();
+}
+
+void ssandPile_finalize_omp_tiled_lazy()
+{
+  lazy_finalize();
+  ssandPile_finalize();
+}
+
+unsigned ssandPile_compute_omp_tiled_lazy(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    int change = 0;
+
+#pragma omp parallel for collapse(2) schedule(runtime) reduction(| : change)
+    for (int ty = 0; ty < NB_TILES_Y; ty++)
+      for (int tx = 0; tx < NB_TILES_X; tx++)
+      {
+        const int x = tx * TILE_W;
+        const int y = ty * TILE_H;
+        int temp    = 0;
+
+        if (tile_needed(ty, tx))
+        {
+          temp = do_tile(x, y, TILE_W, TILE_H, omp_get_thread_num());
+          _dirty[ty * NB_TILES_X + tx] = 1;
+        }
+        else if (_dirty[ty * NB_TILES_X + tx])
+        {
+          // Border cells are 0 in both tables, copying them is harmless
+          for (int i = y; i < y + TILE_H; i++)
+            memcpy(table_cell(TABLE, out, i, x), table_cell(TABLE, in, i, x),
+                   TILE_W * sizeof(TYPE));
+          _dirty[ty * NB_TILES_X + tx] = 0;
+        }
+
+        next_changed(ty, tx) = temp;
+        change |= temp;
+      }
+
+    swap_tables();
+    swap_changed();
+    if (change == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// 16-bit cells version (omp_tiled16)
+// Suggested cmdline:
+// ./run -k ssandPile -s 4096 -a alea -v omp_tiled16 -ts 64
+//
+// Same as omp_tiled, but cells are stored on 16 bits to halve memory
+// traffic (and double the number of cells per AVX2 vector). The rule never
+// overflows: a new cell value is at most 3 + 4 * (65535 / 4) = 65535. So we
+// only check the initial configuration, and fall back to 32-bit cells (and
+// to the current tile function) when it holds larger values.
+
+static uint16_t *TABLE16 = NULL;
+static int use_16bit     = -1; // unknown until the first iteration
+
+#define table16(step, y, x) (TABLE16[DIM * DIM * (step) + (y) * DIM + (x)])
+
+void ssandPile_init_omp_tiled16()
+{
+  ssandPile_init();
+
+  TABLE16 = vec_huge_malloc(2 * DIM * DIM * sizeof(uint16_t));
+}
+
+void ssandPile_finalize_omp_tiled16()
+{
+  vec_huge_free(TABLE16, 2 * DIM * DIM * sizeof(uint16_t));
+
+  ssandPile_finalize();
+}
+
+void ssandPile_refresh_img_omp_tiled16()
+{
+  if (use_16bit == 1)
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < DIM * DIM; i++)
+      table(in, 0, i) = table16(in, 0, i);
+
+  ssandPile_refresh_img();
+}
+
+static void table16_convert(void)
+{
+  TYPE max_value = 0;
+
+#pragma omp parallel for schedule(static) reduction(max : max_value)
+  for (int i = 0; i < DIM * DIM; i++)
+    max_value = max(max_value, table(in, 0, i));
+
+  use_16bit = (max_value <= UINT16_MAX);
+
+  if (!use_16bit)
+  {
+    PRINT_DEBUG('u', "Max cell value is %u: falling back to 32-bit cells\n",
+                max_value);
+    return;
+  }
+
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < 2 * DIM * DIM; i++)
+    TABLE16[i] = TABLE[i];
+}
+
+static int ssandPile_tile16_inner(int x, int y, int width, int height)
+{
+  int diff = 0;
+
+  for (int i = y; i < y + height; i++)
+  {
+    int j = x;
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+    const __m256i three = _mm256_set1_epi16(3);
+    __m256i unstable    = _mm256_setzero_si256();
+
+    for (; j + AVX_VEC_SIZE_SHORT <= x + width; j += AVX_VEC_SIZE_SHORT)
+    {
+      __m256i me = _mm256_loadu_si256((__m256i *)&table16(in, i, j));
+      __m256i n  = _mm256_loadu_si256((__m256i *)&table16(in, i - 1, j));
+      __m256i s  = _mm256_loadu_si256((__m256i *)&table16(in, i + 1, j));
+      __m256i w  = _mm256_loadu_si256((__m256i *)&table16(in, i, j - 1));
+      __m256i e  = _mm256_loadu_si256((__m256i *)&table16(in, i, j + 1));
+
+      __m256i res = _mm256_add_epi16(
+          _mm256_add_epi16(_mm256_and_si256(me, three),
+                           _mm256_srli_epi16(n, 2)),
+          _mm256_add_epi16(_mm256_add_epi16(_mm256_srli_epi16(s, 2),
+                                            _mm256_srli_epi16(w, 2)),
+                           _mm256_srli_epi16(e, 2)));
+
+      _mm256_storeu_si256((__m256i *)&table16(out, i, j), res);
+      unstable = _mm256_or_si256(unstable, _mm256_andnot_si256(three, res));
+    }
+    diff |= !_mm256_testz_si256(unstable, unstable);
+#endif
+
+    for (; j < x + width; j++)
+    {
+      table16(out, i, j) = (table16(in, i, j) & 3) +
+                           (table16(in, i + 1, j) >> 2) +
+                           (table16(in, i - 1, j) >> 2) +
+                           (table16(in, i, j + 1) >> 2) +
+                           (table16(in, i, j - 1) >> 2);
+      diff |= table16(out, i, j) >= 4;
+    }
+  }
+
+  return diff;
+}
+
+static int ssandPile_tile16_border(int x, int y, int width, int height)
+{
+  clip_border_tile(&x, &y, &width, &height);
+
+  return ssandPile_tile16_inner(x, y, width, height);
+}
+
+// Same dispatch as do_tile, which cannot be used here because the tiling
+// flavor bound to the kernel works on 32-bit cells
+static int ssandPile_tile16(int x, int y, int width, int height, int who)
+{
+  int r;
+
+  monitoring_start_tile(who);
+
+  if (x > 0 && y > 0 && x + width < DIM && y + height < DIM)
+    r = ssandPile_tile16_inner(x, y, width, height);
+  else
+    r = ssandPile_tile16_border(x, y, width, height);
+
+  monitoring_end_tile(x, y, width, height, who);
+
+  return r;
+}
+
+unsigned ssandPile_compute_omp_tiled16(unsigned nb_iter)
+{
+  if (use_16bit == -1)
+    table16_convert();
+
+  if (!use_16bit)
+    return ssandPile_compute_omp_tiled(nb_iter);
+
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    int change = 0;
+
+#pragma omp parallel for collapse(2) schedule(runtime) reduction(| : change)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        change |= ssandPile_tile16(x, y, TILE_W, TILE_H, omp_get_thread_num());
+    swap_tables();
+    if (change == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Active area version (frontier)
+// Suggested cmdline:
+// ./run -k ssandPile -s 1024 -a big -v frontier -m
+//
+// With two tables, a cell which changed during the last iteration must be
+// written again to keep both tables in sync, so we sweep the union of the
+// current and previous frontiers.
+
+void ssandPile_init_frontier()
+{
+  ssandPile_init();
+  frontier_reset();
+}
+
+unsigned ssandPile_compute_frontier(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    box_t next = frontier_sweep(box_union(frontier, prev_frontier), 1);
+
+    prev_frontier = frontier;
+    frontier      = next;
+    swap_tables();
+    if (!box_area(frontier))
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// OpenCL versions (ocl, ocl_lazy)
+// Suggested cmdline:
+// ./run -k ssandPile -g -s 4096 -a 4partout -v ocl_lazy
+//
+// Kernels raise the flag changed[slot] when some cell is still unstable
+// after the iteration. We only read these flags back once every OCL_BATCH
+// iterations: since a stable configuration is left untouched by further
+// iterations, we can still report the exact stabilization iteration.
+
+#define OCL_BATCH 32
+
+static cl_mem changed_buffer = 0;
+static cl_mem last_changed_buffer = 0, next_changed_buffer = 0,
+              dirty_buffer = 0;
+
+static cl_mem ocl_alloc_tile_flags(const char *name, unsigned value)
+{
+  const unsigned nb_tiles = (GPU_SIZE_X / GPU_TILE_W) * (GPU_SIZE_Y / GPU_TILE_H);
+  unsigned *tmp = malloc(nb_tiles * sizeof(unsigned));
+  cl_mem buffer;
+  cl_int err;
+
+  buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, nb_tiles * sizeof(unsigned),
+                          NULL, NULL);
+  if (!buffer)
+    exit_with_error("Failed to allocate %s", name);
+
+  for (unsigned i = 0; i < nb_tiles; i++)
+    tmp[i] = value;
+
+  err = clEnqueueWriteBuffer(queue, buffer, CL_TRUE, 0,
+                             nb_tiles * sizeof(unsigned), tmp, 0, NULL, NULL);
+  check(err, "Failed to write to %s", name);
+
+  free(tmp);
+
+  return buffer;
+}
+
+void ssandPile_init_ocl()
+{
+  ssandPile_init();
+
+  changed_buffer = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                  OCL_BATCH * sizeof(unsigned), NULL, NULL);
+  if (!changed_buffer)
+    exit_with_error("Failed to allocate changed_buffer");
+}
+
+void ssandPile_finalize_ocl()
+{
+  clReleaseMemObject(changed_buffer);
+
+  ssandPile_finalize();
+}
+
+void ssandPile_init_ocl_lazy()
+{
+  ssandPile_init_ocl();
+
+  last_changed_buffer = ocl_alloc_tile_flags("last_changed_buffer", 1);
+  next_changed_buffer = ocl_alloc_tile_flags("next_changed_buffer", 0);
+  dirty_buffer        = ocl_alloc_tile_flags("dirty_buffer", 0);
+}
+
+void ssandPile_finalize_ocl_lazy()
+{
+  clReleaseMemObject(last_changed_buffer);
+  clReleaseMemObject(next_changed_buffer);
+  clReleaseMemObject(dirty_buffer);
+
+  ssandPile_finalize_ocl();
+}
+
+static unsigned ssandPile_ocl_iterate(unsigned nb_iter, int lazy)
+{
+  size_t global[2] = {GPU_SIZE_X, GPU_SIZE_Y};
+  size_t local[2]  = {GPU_TILE_W, GPU_TILE_H};
+  const unsigned zero = 0;
+  unsigned flags[OCL_BATCH];
+  unsigned res = 0;
+  cl_int err;
+
+  monitoring_start_tile(easypap_gpu_lane(TASK_TYPE_COMPUTE));
+
+  for (unsigned it = 1; it <= nb_iter && !res; it += OCL_BATCH)
+  {
+    const unsigned batch = min(OCL_BATCH, nb_iter - it + 1);
+
+    err = clEnqueueFillBuffer(queue, changed_buffer, &zero, sizeof(zero), 0,
+                              batch * sizeof(unsigned), 0, NULL, NULL);
+    check(err, "Failed to clear changed_buffer");
+
+    for (unsigned slot = 0; slot < batch; slot++)
+    {
+      unsigned arg = 0;
+
+      err = 0;
+      err |= clSetKernelArg(compute_kernel, arg++, sizeof(cl_mem), &cur_buffer);
+      err |= clSetKernelArg(compute_kernel, arg++, sizeof(cl_mem), &next_buffer);
+      if (lazy)
+      {
+        err |= clSetKernelArg(compute_kernel, arg++, sizeof(cl_mem),
+                              &last_changed_buffer);
+        err |= clSetKernelArg(compute_kernel, arg++, sizeof(cl_mem),
+                              &next_changed_buffer);
+        err |= clSetKernelArg(compute_kernel, arg++, sizeof(cl_mem),
+                              &dirty_buffer);
+      }
+      err |= clSetKernelArg(compute_kernel, arg++, sizeof(cl_mem), &changed_buffer);
+      err |= clSetKernelArg(compute_kernel, arg++, sizeof(unsigned), &slot);
+      check(err, "Failed to set kernel arguments");
+
+      err = clEnqueueNDRangeKernel(queue, compute_kernel, 2, NULL, global, local,
+                                   0, NULL, NULL);
+      check(err, "Failed to execute kernel");
+
+      // Swap buffers
+      {
+        cl_mem tmp  = cur_buffer;
+        cur_buffer  = next_buffer;
+        next_buffer = tmp;
+
+        if (lazy)
+        {
+          tmp                 = last_changed_buffer;
+          last_changed_buffer = next_changed_buffer;
+          next_changed_buffer = tmp;
+        }
+      }
+    }
+
+    err = clEnqueueReadBuffer(queue, changed_buffer, CL_TRUE, 0,
+                              batch * sizeof(unsigned), flags, 0, NULL, NULL);
+    check(err, "Failed to read changed_buffer");
+
+    for (unsigned slot = 0; slot < batch; slot++)
+      if (!flags[slot])
+      {
+        res = it + slot;
+        break;
+      }
+  }
+
+  clFinish(queue);
+
+  monitoring_end_tile(0, 0, DIM, DIM, easypap_gpu_lane(TASK_TYPE_COMPUTE));
+
+  return res;
+}
+
+unsigned ssandPile_invoke_ocl(unsigned nb_iter)
+{
+  return ssandPile_ocl_iterate(nb_iter, 0);
+}
+
+unsigned ssandPile_invoke_ocl_lazy(unsigned nb_iter)
+{
+  return ssandPile_ocl_iterate(nb_iter, 1);
+}
+
 // Only called when --dump or --thumbnails is used
 void ssandPile_refresh_img_ocl ()
 {
@@ -257,6 +884,11 @@ void ssandPile_refresh_img_ocl ()
   ssandPile_refresh_img ();
 }
 
+void ssandPile_refresh_img_ocl_lazy ()
+{
+  ssandPile_refresh_img_ocl ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////// Asynchronous Kernel
@@ -272,8 +904,9 @@ void asandPile_init()
 
     PRINT_DEBUG('u', "Memory footprint = 2 x %d bytes\n", size);
 
-    TABLE = mmap(NULL, size, PROT_READ | PROT_WRITE,
-                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TABLE = vec_huge_malloc(size);
+
+    img_data_register_table("table", TABLE, sizeof(TYPE));
   }
 }
 
@@ -281,7 +914,7 @@ void asandPile_finalize()
 {
   const unsigned size = DIM * DIM * sizeof(TYPE);
 
-  munmap(TABLE, size);
+  vec_huge_free(TABLE, size);
 }
 
 ///////////////////////////// Version séquentielle simple (seq)
@@ -336,4 +969,367 @@ unsigned asandPile_compute_tiled(unsigned nb_iter)
   }
 
   return 0;
-}
\ No newline at end of file
+}
+
+///////////////////////////// OpenMP tiled version (omp_tiled)
+// Suggested cmdline:
+// ./run -k asandPile -s 4096 -a 4partout -v omp_tiled -ts 64
+//
+// Only cells lying on the edge of a tile topple into neighbouring tiles.
+// So each iteration first processes the inside of all tiles in parallel,
+// then the tile edges sequentially (they are few).
+
+static int asandPile_tile_inside(int x, int y, int cpu)
+{
+  return do_tile(x + 1, y + 1, TILE_W - 2, TILE_H - 2, cpu);
+}
+
+static int asandPile_tile_edges(int x, int y, int cpu)
+{
+  const int x0 = x + (x == 0);
+  const int x1 = x + TILE_W - (x + TILE_W == DIM);
+  int change   = 0;
+
+  if (y > 0)
+    change |= do_tile(x0, y, x1 - x0, 1, cpu);
+  if (y + TILE_H < DIM)
+    change |= do_tile(x0, y + TILE_H - 1, x1 - x0, 1, cpu);
+  if (x > 0)
+    change |= do_tile(x, y + 1, 1, TILE_H - 2, cpu);
+  if (x + TILE_W < DIM)
+    change |= do_tile(x + TILE_W - 1, y + 1, 1, TILE_H - 2, cpu);
+
+  return change;
+}
+
+unsigned asandPile_compute_omp_tiled(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    int change = 0;
+
+#pragma omp parallel for collapse(2) schedule(runtime) reduction(| : change)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        change |= asandPile_tile_inside(x, y, omp_get_thread_num());
+
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        change |= asandPile_tile_edges(x, y, 0);
+
+    if (change == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Lazy OpenMP tiled version (omp_tiled_lazy)
+// Same as above, but a tile is skipped when neither itself nor one of its
+// 4 neighbours toppled anything at the previous iteration.
+
+void asandPile_init_omp_tiled_lazy()
+{
+  asandPile_init();
+  lazy_init();
+}
+
+void asandPile_finalize_omp_tiled_lazy()
+{
+  lazy_finalize();
+  asandPile_finalize();
+}
+
+unsigned asandPile_compute_omp_tiled_lazy(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    int change = 0;
+
+#pragma omp parallel for collapse(2) schedule(runtime) reduction(| : change)
+    for (int ty = 0; ty < NB_TILES_Y; ty++)
+      for (int tx = 0; tx < NB_TILES_X; tx++)
+      {
+        int temp = 0;
+
+        if (tile_needed(ty, tx))
+          temp = asandPile_tile_inside(tx * TILE_W, ty * TILE_H,
+                                       omp_get_thread_num());
+
+        next_changed(ty, tx) = temp;
+        change |= temp;
+      }
+
+    for (int ty = 0; ty < NB_TILES_Y; ty++)
+      for (int tx = 0; tx < NB_TILES_X; tx++)
+        if (tile_needed(ty, tx) &&
+            asandPile_tile_edges(tx * TILE_W, ty * TILE_H, 0))
+          next_changed(ty, tx) = change = 1;
+
+    swap_changed();
+    if (change == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+static inline int asandPile_tile(int tx, int ty, int cpu)
+{
+  const int x = tx * TILE_W;
+  const int y = ty * TILE_H;
+
+  return do_tile(x + (x == 0), y + (y == 0),
+                 TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                 TILE_H - ((y + TILE_H == DIM) + (y == 0)), cpu);
+}
+
+///////////////////////////// Coloured OpenMP version (omp_checkerboard)
+// Suggested cmdline:
+// ./run -k asandPile -s 1024 -a big -v omp_checkerboard -ts 32
+//
+// A tile writes into the edges of its 4 neighbours, so two diagonal tiles
+// both write into the corner cells of the tiles they share: a red-black
+// colouring is not enough. With a 2x2 colouring, tiles of the same colour
+// never touch the same cells, so each colour is processed in parallel.
+
+unsigned asandPile_compute_omp_checkerboard(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    int change = 0;
+
+#pragma omp parallel
+    for (int colour = 0; colour < 4; colour++)
+#pragma omp for collapse(2) schedule(runtime) reduction(| : change)
+      for (int ty = colour / 2; ty < NB_TILES_Y; ty += 2)
+        for (int tx = colour % 2; tx < NB_TILES_X; tx += 2)
+          change |= asandPile_tile(tx, ty, omp_get_thread_num());
+
+    if (change == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// OpenMP tasks with dependencies (omp_task_dep)
+// Each tile task updates its own tile and reads/writes the 8 surrounding
+// ones, so tasks are chained with the tasks of neighbouring tiles only. This
+// yields the same result as the tiled version, while letting successive
+// iterations overlap: we submit TASK_WINDOW iterations at a time and record
+// changes per iteration.
+
+#define TASK_WINDOW 8
+
+static char *_tile_deps = NULL;
+
+// Padded by one tile on each side so that no bound check is needed
+#define tile_dep(ty, tx) (_tile_deps[((ty) + 1) * (NB_TILES_X + 2) + (tx) + 1])
+
+void asandPile_init_omp_task_dep()
+{
+  asandPile_init();
+
+  _tile_deps = calloc((NB_TILES_X + 2) * (NB_TILES_Y + 2), 1);
+}
+
+void asandPile_finalize_omp_task_dep()
+{
+  free(_tile_deps);
+
+  asandPile_finalize();
+}
+
+unsigned asandPile_compute_omp_task_dep(unsigned nb_iter)
+{
+  unsigned res = 0;
+
+#pragma omp parallel
+#pragma omp single
+  for (unsigned it = 1; it <= nb_iter && !res; it += TASK_WINDOW)
+  {
+    const unsigned window = min(TASK_WINDOW, nb_iter - it + 1);
+    int change[TASK_WINDOW] = {0};
+
+    for (unsigned w = 0; w < window; w++)
+      for (int ty = 0; ty < NB_TILES_Y; ty++)
+        for (int tx = 0; tx < NB_TILES_X; tx++)
+#pragma omp task firstprivate(w, tx, ty) shared(change)                       \
+    depend(inout : tile_dep(ty, tx))                                          \
+    depend(in : tile_dep(ty - 1, tx - 1), tile_dep(ty - 1, tx),               \
+               tile_dep(ty - 1, tx + 1), tile_dep(ty, tx - 1),                \
+               tile_dep(ty, tx + 1), tile_dep(ty + 1, tx - 1),                \
+               tile_dep(ty + 1, tx), tile_dep(ty + 1, tx + 1))
+          if (asandPile_tile(tx, ty, omp_get_thread_num()))
+            __atomic_store_n(&change[w], 1, __ATOMIC_RELAXED);
+
+#pragma omp taskwait
+
+    for (unsigned w = 0; w < window; w++)
+      if (!change[w])
+      {
+        res = it + w;
+        break;
+      }
+  }
+
+  return res;
+}
+
+///////////////////////////// Active area version (frontier)
+// Suggested cmdline:
+// ./run -k asandPile -s 1024 -a big -v frontier -m
+//
+// Cells are toppled in place, so tiles are swept sequentially.
+
+void asandPile_init_frontier()
+{
+  asandPile_init();
+  frontier_reset();
+}
+
+unsigned asandPile_compute_frontier(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    frontier = frontier_sweep(frontier, 0);
+    if (!box_area(frontier))
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Two-level version (coarse)
+// Suggested cmdline:
+// ./run -k asandPile -s 512 -a big -v coarse -ts 32 -d u
+//
+// Cells already topple floor(g/4) grains at once, but grains moving up or
+// left only travel one cell per sweep. During a first coarse phase, each
+// tile is toppled again and again until it is locally stable, which flushes
+// its excess grains to its neighbours while it sits in cache. This is valid
+// because the final configuration does not depend on the toppling order.
+// Tiles are processed with the 2x2 colouring of omp_checkerboard, so there
+// is much more work between two barriers. Once no tile needs more than
+// COARSE_ROUNDS rounds, piles are small and we switch to the regular
+// one-sweep-per-iteration scheme.
+
+#define COARSE_ROUNDS 16
+
+static int coarse_phase = 1;
+static unsigned coarse_iterations = 0;
+
+void asandPile_init_coarse()
+{
+  asandPile_init();
+  coarse_phase      = 1;
+  coarse_iterations = 0;
+}
+
+unsigned asandPile_compute_coarse(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    int change = 0, max_rounds = 0;
+
+#pragma omp parallel
+    for (int colour = 0; colour < 4; colour++)
+#pragma omp for collapse(2) schedule(runtime) reduction(| : change)           \
+    reduction(max : max_rounds)
+      for (int ty = colour / 2; ty < NB_TILES_Y; ty += 2)
+        for (int tx = colour % 2; tx < NB_TILES_X; tx += 2)
+          if (coarse_phase)
+          {
+            int rounds = 0;
+
+            while (asandPile_tile(tx, ty, omp_get_thread_num()))
+              rounds++;
+
+            change |= (rounds > 0);
+            max_rounds = max(max_rounds, rounds);
+          }
+          else
+            change |= asandPile_tile(tx, ty, omp_get_thread_num());
+
+    if (coarse_phase)
+    {
+      coarse_iterations++;
+      if (max_rounds <= COARSE_ROUNDS)
+      {
+        PRINT_DEBUG('u', "Switching to fine toppling after %u iterations\n",
+                    coarse_iterations);
+        coarse_phase = 0;
+      }
+    }
+
+    if (change == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Task graph version using our scheduler (sched)
+// Tiles write into the border cells of their 8 neighbours, so tile (i, j)
+// waits for tiles (i - 1, j), (i - 1, j + 1) and (i, j - 1): each iteration
+// gives the same result as the tiled version.
+
+static task_handle_t *handles = NULL;
+static int sched_change       = 0;
+
+void asandPile_init_sched()
+{
+  asandPile_init();
+
+  handles = malloc(NB_TILES_X * NB_TILES_Y * sizeof(task_handle_t));
+
+  scheduler_init(-1);
+}
+
+void asandPile_finalize_sched()
+{
+  scheduler_finalize();
+
+  free(handles);
+
+  asandPile_finalize();
+}
+
+static void asandPile_tile_task(void *p, unsigned cpu)
+{
+  const unsigned tile = (uintptr_t)p;
+
+  if (asandPile_tile(tile % NB_TILES_X, tile / NB_TILES_X, cpu))
+    __atomic_store_n(&sched_change, 1, __ATOMIC_RELAXED);
+}
+
+#define handle(i, j) handles[(i) * NB_TILES_X + (j)]
+
+unsigned asandPile_compute_sched(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    sched_change = 0;
+
+    for (int i = 0; i < NB_TILES_Y; i++)
+      for (int j = 0; j < NB_TILES_X; j++)
+      {
+        task_handle_t deps[3] = {
+            i > 0 ? handle(i - 1, j) : NULL,
+            (i > 0 && j < NB_TILES_X - 1) ? handle(i - 1, j + 1) : NULL,
+            j > 0 ? handle(i, j - 1) : NULL};
+
+        handle(i, j) = scheduler_create_task_dep(
+            asandPile_tile_task, (void *)(uintptr_t)(i * NB_TILES_X + j), -1,
+            deps, 3);
+      }
+
+    scheduler_task_wait();
+
+    if (sched_change == 0)
+      return it;
+  }
+
+  return 0;
+}
@@ -6,6 +6,12 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <omp.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+#include <immintrin.h>
+#endif
 
 ///////////////////////////// Simple sequential version (seq)
 // Suggested cmdline(s):
@@ -79,6 +85,103 @@ unsigned scrollup_compute_tiled (unsigned nb_iter)
   return 0;
 }
 
+// Copies a row segment. When AVX2 is available, the destination is written
+// with non-temporal stores: it will not be read before the next pass, so
+// there is no point in polluting the caches with it.
+static inline void copy_row (uint32_t *restrict dst, uint32_t *restrict src,
+                             int width)
+{
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+  int j = 0;
+
+  for (; j < width && ((uintptr_t)(dst + j) % 32); j++)
+    dst[j] = src[j];
+
+  for (; j + AVX_VEC_SIZE_INT <= width; j += AVX_VEC_SIZE_INT)
+    _mm256_stream_si256 ((__m256i *)(dst + j),
+                         _mm256_loadu_si256 ((__m256i *)(src + j)));
+
+  for (; j < width; j++)
+    dst[j] = src[j];
+#else
+  memcpy (dst, src, width * sizeof (uint32_t));
+#endif
+}
+
+// Makes non-temporal stores of the calling thread globally visible
+static inline void copy_fence (void)
+{
+#if defined(ENABLE_VECTO) && (__AVX2__ == 1)
+  _mm_sfence ();
+#endif
+}
+
+///////////////////////////// Batched streaming version (omp_tiled)
+// Suggested cmdline(s):
+// ./run -l images/1024.png -k scrollup -v omp_tiled -ts 64 -i 1000 -n
+//
+// The nb_iter scrolls are applied in a single copy pass: row i of the result
+// is row (i + nb_iter) % DIM of the source.
+//
+unsigned scrollup_compute_omp_tiled (unsigned nb_iter)
+{
+  const unsigned shift = nb_iter % DIM;
+
+  #pragma omp parallel for schedule(runtime) collapse(2)
+  for (int y = 0; y < DIM; y += TILE_H)
+    for (int x = 0; x < DIM; x += TILE_W) {
+      monitoring_start_tile (omp_get_thread_num ());
+
+      for (int i = y; i < y + TILE_H; i++)
+        copy_row (&next_img (i, x), &cur_img ((i + shift) % DIM, x), TILE_W);
+      copy_fence ();
+
+      monitoring_end_tile (x, y, TILE_W, TILE_H, omp_get_thread_num ());
+    }
+
+  swap_images ();
+
+  return 0;
+}
+
+///////////////////////////// Ring buffer version (ring)
+// Suggested cmdline(s):
+// ./run -l images/1024.png -k scrollup -v ring -i 1000 -n
+//
+// Pixels are never moved by the computation: cur_img is addressed through a
+// rotating row offset (ring_img), so scrolling by k rows costs O(1). The image
+// is materialized only when it is actually needed, i.e. when the refresh_img
+// hook is called (display, thumbnails, --dump).
+//
+static unsigned ring_offset = 0; // row of cur_img shown at the top
+
+#define ring_img(y, x) cur_img (((y) + ring_offset) % DIM, (x))
+
+unsigned scrollup_compute_ring (unsigned nb_iter)
+{
+  ring_offset = (ring_offset + nb_iter) % DIM;
+
+  return 0;
+}
+
+void scrollup_refresh_img_ring (void)
+{
+  if (ring_offset == 0)
+    return;
+
+  #pragma omp parallel
+  {
+    #pragma omp for schedule(static)
+    for (int i = 0; i < DIM; i++)
+      copy_row (&next_img (i, 0), &ring_img (i, 0), DIM);
+
+    copy_fence ();
+  }
+
+  swap_images ();
+  ring_offset = 0;
+}
+
 
 //////////// OpenCL version using mask (ocl_ouf)
 // Suggested cmdlines:
@@ -1,7 +1,9 @@
 
 #include "easypap.h"
+#include "transpose_block.h"
 
 #include <omp.h>
+#include <string.h>
 
 // Tile inner computation
 int transpose_do_tile_default (int x, int y, int width, int height)
@@ -13,6 +15,30 @@ int transpose_do_tile_default (int x, int y, int width, int height)
   return 0;
 }
 
+///////////////////////////// Blocked tiling (avx2)
+// Suggested cmdline:
+// ./run -l images/shibuya.png -k transpose -v omp_tiled -wt avx2 -ts 64
+//
+// Tiles are transposed by 8x8 blocks within AVX2 registers
+int transpose_do_tile_avx2 (int x, int y, int width, int height)
+{
+  transpose_block (&next_img (y, x), DIM, &cur_img (x, y), DIM, width,
+                   height);
+
+  return 0;
+}
+
+///////////////////////////// Cache-oblivious tiling (rec)
+// Suggested cmdline:
+// ./run -l images/shibuya.png -k transpose -v seq -wt rec
+//
+int transpose_do_tile_rec (int x, int y, int width, int height)
+{
+  transpose_rec (&next_img (y, x), DIM, &cur_img (x, y), DIM, width, height);
+
+  return 0;
+}
+
 ///////////////////////////// Simple sequential version (seq)
 // Suggested cmdline:
 // ./run --load-image images/shibuya.png --kernel transpose --pause
@@ -47,3 +73,101 @@ unsigned transpose_compute_tiled (unsigned nb_iter)
 
   return 0;
 }
+
+///////////////////////////// Tiled parallel version (omp_tiled)
+// Suggested cmdline:
+// ./run -l images/shibuya.png -k transpose -v omp_tiled -ts 64 -wt avx2
+//
+unsigned transpose_compute_omp_tiled (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    #pragma omp parallel for schedule(runtime) collapse(2)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        do_tile (x, y, TILE_W, TILE_H, omp_get_thread_num ());
+
+    swap_images ();
+  }
+
+  return 0;
+}
+
+///////////////////////////// In-place parallel version (omp_inplace)
+// Suggested cmdline:
+// ./run -l images/shibuya.png -k transpose -v omp_inplace -ts 64
+//
+// The image is transposed within cur_img (alt_image is never used): tiles
+// (tx, ty) and (ty, tx) are transposed and swapped through a private buffer
+// holding one tile, and diagonal tiles are transposed onto themselves.
+//
+// One tile buffer per OpenMP thread
+static uint32_t *tile_buffers = NULL;
+
+void transpose_init_omp_inplace (void)
+{
+  if (TILE_W != TILE_H)
+    exit_with_error ("omp_inplace requires square tiles (%d x %d)", TILE_W,
+                     TILE_H);
+
+  tile_buffers = malloc (omp_get_max_threads () * TILE_W * TILE_H *
+                         sizeof (uint32_t));
+  if (tile_buffers == NULL)
+    exit_with_error ("Cannot allocate tile buffers");
+}
+
+void transpose_finalize_omp_inplace (void)
+{
+  free (tile_buffers);
+}
+
+static void transpose_swap_tiles (int tx, int ty, uint32_t *restrict buffer)
+{
+  const int x = tx * TILE_W, y = ty * TILE_H;
+
+  transpose_block (buffer, TILE_W, &cur_img (y, x), DIM, TILE_W, TILE_H);
+
+  if (tx != ty)
+    transpose_block (&cur_img (y, x), DIM, &cur_img (x, y), DIM, TILE_W,
+                     TILE_H);
+
+  for (int a = 0; a < TILE_H; a++)
+    memcpy (&cur_img (x + a, y), buffer + a * TILE_W,
+            TILE_W * sizeof (uint32_t));
+}
+
+unsigned transpose_compute_omp_inplace (unsigned nb_iter)
+{
+  const int nb_tiles = NB_TILES_X;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+
+    #pragma omp parallel for schedule(dynamic) collapse(2)
+    for (int ty = 0; ty < nb_tiles; ty++)
+      for (int tx = 0; tx < nb_tiles; tx++)
+        if (tx >= ty) {
+          const int cpu = omp_get_thread_num ();
+
+          monitoring_start_tile (cpu);
+
+          transpose_swap_tiles (tx, ty,
+                                tile_buffers + cpu * TILE_W * TILE_H);
+
+          monitoring_end_tile (tx * TILE_W, ty * TILE_H, TILE_W, TILE_H, cpu);
+        }
+  }
+
+  return 0;
+}
+
+///////////////////////////// OpenCL version with local memory (ocl_local)
+// Suggested cmdline:
+// ./run -l images/shibuya.png -k transpose -o -v ocl_local
+//
+// Tiles are transposed in local memory, so they must be square
+void transpose_init_ocl_local (void)
+{
+  if (GPU_TILE_W != GPU_TILE_H)
+    exit_with_error ("Tiles should have a square shape (%d != %d)", GPU_TILE_W,
+                     GPU_TILE_H);
+}
@@ -0,0 +1,90 @@
+#include "kernel/ocl/common.cl"
+
+#ifdef PARAM
+#define RADIUS PARAM
+#else
+#define RADIUS 1
+#endif
+
+#define LOC_W (GPU_TILE_W + 2 * RADIUS)
+#define LOC_H (GPU_TILE_H + 2 * RADIUS)
+
+// Number of pixels of the window centered on row (or column) i
+static int window (int i)
+{
+  return min (i + RADIUS, DIM - 1) - max (i - RADIUS, 0) + 1;
+}
+
+// Separable box blur of radius PARAM (default 1). Each work-group loads its
+// tile and a halo of RADIUS pixels into local memory (pixels outside of the
+// image are read as 0 and not counted). Rows of the local tile are then
+// summed with running sums, one work item per row, and columns of these row
+// sums likewise, one work item per column: the cost per pixel does not depend
+// on RADIUS. As in the CPU engine, each channel gets the truncated mean of
+// the window. Local memory usage grows with RADIUS, so large radii require
+// small tiles.
+__kernel void blur_ocl (__global unsigned *in, __global unsigned *out)
+{
+  __local unsigned tile [LOC_H][LOC_W];
+  __local uint4 sum [LOC_H][GPU_TILE_W];
+  int x    = get_global_id (0);
+  int y    = get_global_id (1);
+  int xloc = get_local_id (0);
+  int yloc = get_local_id (1);
+  int l    = yloc * GPU_TILE_W + xloc;
+  int x0   = x - xloc - RADIUS;
+  int y0   = y - yloc - RADIUS;
+
+  // Load tile and halo
+  for (int i = yloc; i < LOC_H; i += GPU_TILE_H)
+    for (int j = xloc; j < LOC_W; j += GPU_TILE_W) {
+      int yy = y0 + i;
+      int xx = x0 + j;
+
+      tile [i][j] = (yy >= 0 && yy < DIM && xx >= 0 && xx < DIM)
+                        ? in [yy * DIM + xx] : 0;
+    }
+
+  barrier (CLK_LOCAL_MEM_FENCE);
+
+  // Horizontal pass, halo rows included
+  for (int i = l; i < LOC_H; i += GPU_TILE_W * GPU_TILE_H) {
+    uint4 s = 0;
+
+    for (int k = 0; k <= 2 * RADIUS; k++)
+      s += convert_uint4 (color_to_int4 (tile [i][k]));
+    sum [i][0] = s;
+
+    for (int j = 1; j < GPU_TILE_W; j++) {
+      s += convert_uint4 (color_to_int4 (tile [i][j + 2 * RADIUS]));
+      s -= convert_uint4 (color_to_int4 (tile [i][j - 1]));
+      sum [i][j] = s;
+    }
+  }
+
+  barrier (CLK_LOCAL_MEM_FENCE);
+
+  // Vertical pass: row i of sum receives the window sum of output row i,
+  // once the row sums it held are no longer needed
+  for (int j = l; j < GPU_TILE_W; j += GPU_TILE_W * GPU_TILE_H) {
+    uint4 s = 0;
+
+    for (int k = 0; k <= 2 * RADIUS; k++)
+      s += sum [k][j];
+
+    for (int i = 0; i < GPU_TILE_H; i++) {
+      uint4 first = sum [i][j];
+
+      sum [i][j] = s;
+      if (i + 1 < GPU_TILE_H)
+        s += sum [i + 2 * RADIUS + 1][j] - first;
+    }
+  }
+
+  barrier (CLK_LOCAL_MEM_FENCE);
+
+  // Integer division gives the exact truncated mean
+  uint4 mean = sum [yloc][xloc] / (uint4) (window (x) * window (y));
+
+  out [y * DIM + x] = int4_to_color (convert_int4 (mean));
+}
@@ -0,0 +1,73 @@
+#include "kernel/ocl/common.cl"
+
+#define LOC_W (GPU_TILE_W + 2)
+#define LOC_H (GPU_TILE_H + 2)
+
+static unsigned load_pixel (__global unsigned *img, int y, int x)
+{
+  return (y >= 0 && y < DIM && x >= 0 && x < DIM) ? img [y * DIM + x] : 0;
+}
+
+// Each work-group loads its tile (plus a one-pixel halo taken from the
+// neighbouring tiles) into local memory, then propagates the max color
+// between non-black neighbours until the tile is locally stable. At each
+// round, all work items first read their neighbours, then update their own
+// pixel after a barrier. Since values only grow, halos may be read while
+// neighbouring work-groups update the image in place: reading a pixel before
+// or after its update is equally valid.
+__kernel void max_ocl (__global unsigned *img, __global unsigned *changed,
+                       unsigned slot)
+{
+  int x    = get_global_id (0);
+  int y    = get_global_id (1);
+  int xloc = get_local_id (0) + 1;
+  int yloc = get_local_id (1) + 1;
+
+  __local unsigned tile [LOC_H][LOC_W];
+  __local int local_change;
+
+  // Load tile and halo
+  tile [yloc][xloc] = load_pixel (img, y, x);
+  if (xloc == 1)
+    tile [yloc][0] = load_pixel (img, y, x - 1);
+  if (xloc == GPU_TILE_W)
+    tile [yloc][LOC_W - 1] = load_pixel (img, y, x + 1);
+  if (yloc == 1)
+    tile [0][xloc] = load_pixel (img, y - 1, x);
+  if (yloc == GPU_TILE_H)
+    tile [LOC_H - 1][xloc] = load_pixel (img, y + 1, x);
+
+  unsigned me = tile [yloc][xloc];
+  int mine    = 0;
+
+  do {
+    unsigned m = 0;
+
+    // Tile loaded, or local_change read by everybody
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    if (xloc == 1 && yloc == 1)
+      local_change = 0;
+
+    if (me)
+      m = max (max (tile [yloc - 1][xloc], tile [yloc + 1][xloc]),
+               max (tile [yloc][xloc - 1], tile [yloc][xloc + 1]));
+
+    // Neighbours must not be modified before everybody has read them
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    if (m > me) {
+      me                = m;
+      tile [yloc][xloc] = m;
+      local_change      = 1;
+      mine              = 1;
+    }
+
+    barrier (CLK_LOCAL_MEM_FENCE);
+  } while (local_change);
+
+  if (mine) {
+    img [y * DIM + x] = me;
+    changed [slot]    = 1;
+  }
+}
@@ -45,3 +45,93 @@ __kernel void pixelize_ocl_opt (__global unsigned *in)
   
   in [y * DIM + x] = int4_to_color (tile [0] / (int4) (GPU_TILE_W * GPU_TILE_H));
 }
+
+// Summed-area table pixelization, launched four times per iteration. Each
+// work-group works on a GPU_TILE_W x GPU_TILE_H tile, kept in local memory
+// during the scans:
+//  - phase 0: parallel prefix scan of each row segment of the tile into row
+//    y + 1 of the table; the segment totals go to row_carry;
+//  - phase 1: carry pass along rows (totals of the previous segments of the
+//    row are added), then parallel prefix scan of each column segment of the
+//    tile; the segment totals go to col_carry;
+//  - phase 2: carry pass along columns;
+//  - phase 3: each pixel gets the exact mean of its block, obtained from four
+//    cells of the table. Blocks may have any size.
+// Sums are computed modulo 2^32, which is exact as long as a block sums to
+// less than 2^32.
+
+#define SAT_NB_TILES_X (DIM / GPU_TILE_W)
+
+__kernel void pixelize_ocl_sat (__global unsigned *in, __global uint4 *sat,
+                                __global uint4 *carry, unsigned phase, int bw,
+                                int bh)
+{
+  __local uint4 tile [GPU_TILE_H][GPU_TILE_W];
+  int x = get_global_id (0);
+  int y = get_global_id (1);
+  int xloc = get_local_id (0);
+  int yloc = get_local_id (1);
+  int tx = get_group_id (0);
+  int ty = get_group_id (1);
+  __global uint4 *row_carry = carry; // DIM x SAT_NB_TILES_X segment totals
+  __global uint4 *col_carry = carry + DIM * SAT_NB_TILES_X; // idem x DIM
+  __global uint4 *cell = sat + (y + 1) * (DIM + 1) + x + 1;
+
+  if (phase == 0) {
+    tile [yloc][xloc] = convert_uint4 (*(__global uchar4 *) &in [y * DIM + x]);
+
+    // Hillis-Steele inclusive scan of the row segment
+    for (int d = 1; d < GPU_TILE_W; d <<= 1) {
+      barrier (CLK_LOCAL_MEM_FENCE);
+      uint4 v = (xloc >= d) ? tile [yloc][xloc - d] : (uint4) 0;
+      barrier (CLK_LOCAL_MEM_FENCE);
+      tile [yloc][xloc] += v;
+    }
+
+    *cell = tile [yloc][xloc];
+    if (xloc == GPU_TILE_W - 1)
+      row_carry [y * SAT_NB_TILES_X + tx] = tile [yloc][xloc];
+
+    // Row 0 and column 0 hold zeros
+    if (x == 0)
+      sat [(y + 1) * (DIM + 1)] = 0;
+    if (y == 0)
+      sat [x + 1] = 0;
+    if (x == 0 && y == 0)
+      sat [0] = 0;
+  } else if (phase == 1) {
+    uint4 sum = *cell;
+
+    for (int k = 0; k < tx; k++)
+      sum += row_carry [y * SAT_NB_TILES_X + k];
+    tile [yloc][xloc] = sum;
+
+    // Same scan on the column segment
+    for (int d = 1; d < GPU_TILE_H; d <<= 1) {
+      barrier (CLK_LOCAL_MEM_FENCE);
+      uint4 v = (yloc >= d) ? tile [yloc - d][xloc] : (uint4) 0;
+      barrier (CLK_LOCAL_MEM_FENCE);
+      tile [yloc][xloc] += v;
+    }
+
+    *cell = tile [yloc][xloc];
+    if (yloc == GPU_TILE_H - 1)
+      col_carry [ty * DIM + x] = tile [yloc][xloc];
+  } else if (phase == 2) {
+    uint4 sum = 0;
+
+    for (int k = 0; k < ty; k++)
+      sum += col_carry [k * DIM + x];
+    *cell += sum;
+  } else {
+    int x0 = x - x % bw;
+    int y0 = y - y % bh;
+    int x1 = min (x0 + bw, DIM);
+    int y1 = min (y0 + bh, DIM);
+    uint4 sum = sat [y1 * (DIM + 1) + x1] - sat [y0 * (DIM + 1) + x1] -
+                sat [y1 * (DIM + 1) + x0] + sat [y0 * (DIM + 1) + x0];
+    uint4 mean = sum / (uint4) ((x1 - x0) * (y1 - y0));
+
+    in [y * DIM + x] = int4_to_color (convert_int4 (mean));
+  }
+}
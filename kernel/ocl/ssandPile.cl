@@ -1,12 +1,80 @@
 #include "kernel/ocl/common.cl"
 
 
-__kernel void ssandPile_ocl (__global unsigned *in, __global unsigned *out)
+static inline unsigned ssandPile_cell (__global unsigned *in, int y, int x)
+{
+  return in [y * DIM + x] % 4 + in [(y - 1) * DIM + x] / 4 +
+         in [(y + 1) * DIM + x] / 4 + in [y * DIM + x - 1] / 4 +
+         in [y * DIM + x + 1] / 4;
+}
+
+// changed[slot] is raised as soon as one cell remains unstable
+__kernel void ssandPile_ocl (__global unsigned *in, __global unsigned *out,
+                             __global unsigned *changed, unsigned slot)
 {
   int x = get_global_id (0);
   int y = get_global_id (1);
 
-  //TODO
+  if (y > 0 && y < DIM - 1 && x > 0 && x < DIM - 1) {
+    unsigned v = ssandPile_cell (in, y, x);
+
+    out [y * DIM + x] = v;
+    if (v >= 4)
+      changed [slot] = 1;
+  }
+}
+
+// A work-group only computes its tile if itself or one of its 4 neighbours
+// held unstable cells at the previous iteration. A tile computed at the
+// previous iteration is copied once into out, so that both buffers agree
+// when it is skipped afterwards.
+__kernel void ssandPile_ocl_lazy (__global unsigned *in, __global unsigned *out,
+                                  __global unsigned *last_changed,
+                                  __global unsigned *next_changed,
+                                  __global unsigned *dirty,
+                                  __global unsigned *changed, unsigned slot)
+{
+  int x      = get_global_id (0);
+  int y      = get_global_id (1);
+  int tile_x = get_group_id (0);
+  int tile_y = get_group_id (1);
+  int nb_x   = get_num_groups (0);
+  int nb_y   = get_num_groups (1);
+  int tile   = tile_y * nb_x + tile_x;
+  int leader = get_local_id (0) == 0 && get_local_id (1) == 0;
+
+  local unsigned needed, was_dirty, unstable;
+
+  if (leader) {
+    needed = last_changed [tile] | (tile_y > 0 ? last_changed [tile - nb_x] : 0) |
+             (tile_y < nb_y - 1 ? last_changed [tile + nb_x] : 0) |
+             (tile_x > 0 ? last_changed [tile - 1] : 0) |
+             (tile_x < nb_x - 1 ? last_changed [tile + 1] : 0);
+    was_dirty = dirty [tile];
+    unstable  = 0;
+  }
+
+  barrier (CLK_LOCAL_MEM_FENCE);
+
+  if (needed) {
+    if (y > 0 && y < DIM - 1 && x > 0 && x < DIM - 1) {
+      unsigned v = ssandPile_cell (in, y, x);
+
+      out [y * DIM + x] = v;
+      if (v >= 4)
+        atomic_or (&unstable, 1);
+    }
+  } else if (was_dirty)
+    out [y * DIM + x] = in [y * DIM + x];
+
+  barrier (CLK_LOCAL_MEM_FENCE);
+
+  if (leader) {
+    next_changed [tile] = unstable;
+    dirty [tile]        = needed;
+    if (unstable)
+      changed [slot] = 1;
+  }
 }
 
 
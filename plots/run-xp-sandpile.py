@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+
+from expTools import *
+import csv
+import os
+
+# Runs every configuration until it is stable: the csv file records the
+# number of iterations needed to reach stability, and the wall time
+output = "./plots/data/sandpile.csv"
+
+# easypap appends to the csv file: start afresh so that the summary only
+# reports this run
+if os.path.exists(output):
+    os.remove(output)
+
+easypapOptions = {
+    "-k ": ["asandPile"],
+    "-v ": ["tiled", "omp_checkerboard", "coarse"],
+    "-s ": [512],
+    "-ts ": [32],
+    "-a ": ["4partout", "DIM", "alea", "big", "spirals"],
+    "-of ": [output]
+}
+
+ompICV = {
+    "OMP_NUM_THREADS=": [1, 4]
+}
+
+nbrun = 1
+
+execute('./run ', ompICV, easypapOptions, nbrun, verbose=True, easyPath=".")
+
+easypapOptions["-k "] = ["ssandPile"]
+easypapOptions["-v "] = ["tiled", "omp_tiled_lazy", "omp_tiled16"]
+
+execute('./run ', ompICV, easypapOptions, nbrun, verbose=True, easyPath=".")
+
+# Summary: iterations to stability and wall time for each draw configuration
+with open(output) as f:
+    print("{:<10} {:<18} {:<10} {:>7} {:>10} {:>12}".format(
+        "kernel", "variant", "arg", "threads", "iterations", "time (ms)"))
+    for row in csv.DictReader(f, delimiter=';'):
+        if row["kernel"] in ("asandPile", "ssandPile"):
+            print("{:<10} {:<18} {:<10} {:>7} {:>10} {:>12.3f}".format(
+                row["kernel"], row["variant"], row["arg"], row["threads"],
+                row["iterations"], int(row["time"]) / 1000))
@@ -5,7 +5,8 @@ import os
 
 easyspap_options = {}
 easyspap_options["--kernel "] = ["scrollup"]
-easyspap_options["--variant "] = ["seq", "ji"]
+# ring never moves pixels, omp_tiled moves them once per batch
+easyspap_options["--variant "] = ["seq", "ji", "omp_tiled", "ring"]
 easyspap_options["-of "] = ["scrollup.csv"]
 
 omp_icv = {}  # OpenMP Internal Control Variables
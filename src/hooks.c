@@ -24,6 +24,8 @@ void_func_t the_refresh_img = NULL;
 void_func_t the_tile_check  = NULL;
 
 static tile_func_t the_tile_func = NULL;
+// Optional fast path for the tiles which do not touch the image border
+static tile_func_t the_inner_tile_func = NULL;
 
 void *hooks_find_symbol (char *symbol)
 {
@@ -53,21 +55,44 @@ static void *bind_it (char *kernel, char *s, char *variant, int print_error)
   return fun;
 }
 
-static void *bind_tile (char *kernel)
+// A tiling flavor is either implemented by a single function
+// <kernel>_do_tile_<flavor>, or by a pair of functions
+// <kernel>_do_tile_<flavor>_inner and <kernel>_do_tile_<flavor>_border. In the
+// latter case, the inner function is only called on tiles which do not touch
+// the image border, so it may access neighbouring pixels without any check.
+static int bind_tile_flavor (char *kernel, char *flavor)
 {
   char buffer[1024];
-  void *fun = NULL;
 
+  sprintf (buffer, "%s_do_tile_%s", kernel, flavor);
+  the_tile_func = hooks_find_symbol (buffer);
+  if (the_tile_func != NULL) {
+    PRINT_DEBUG ('c', "Found [%s]\n", buffer);
+    return 1;
+  }
+
+  sprintf (buffer, "%s_do_tile_%s_inner", kernel, flavor);
+  the_inner_tile_func = hooks_find_symbol (buffer);
+  sprintf (buffer, "%s_do_tile_%s_border", kernel, flavor);
+  the_tile_func = hooks_find_symbol (buffer);
+  if (the_tile_func != NULL && the_inner_tile_func != NULL) {
+    PRINT_DEBUG ('c', "Found [%s] and its inner counterpart\n", buffer);
+    return 1;
+  }
+
+  the_tile_func = the_inner_tile_func = NULL;
+  return 0;
+}
+
+static void bind_tile (char *kernel)
+{
   // First try to obey user
   if (tile_name != NULL) {
-    sprintf (buffer, "%s_do_tile_%s", kernel, tile_name);
-    fun = hooks_find_symbol (buffer);
-    if (fun != NULL) {
-      PRINT_DEBUG ('c', "Found requested tiling func [%s]\n", buffer);
-      return fun;
-    }
+    if (bind_tile_flavor (kernel, tile_name))
+      return;
     // requested tile_name didn't work
-    exit_with_error ("Cannot resolve function [%s]\n", buffer);
+    exit_with_error ("Cannot resolve function [%s_do_tile_%s]\n", kernel,
+                     tile_name);
   }
 
   // Try to explore EASYPAP_TILEPREF environment variable
@@ -80,13 +105,11 @@ static void *bind_tile (char *kernel)
         if (env[index_env] == ':' ||
             env[index_env] == '\0') { // end of flavor name
           flavor[index] = '\0';
-          sprintf (buffer, "%s_do_tile_%s", kernel, flavor);
-          fun = hooks_find_symbol (buffer);
-          if (fun != NULL) {
-            PRINT_DEBUG ('c', "Found preferred tiling func [%s]\n", buffer);
+          if (bind_tile_flavor (kernel, flavor)) {
+            PRINT_DEBUG ('c', "Using preferred tiling flavor [%s]\n", flavor);
             tile_name = malloc (strlen (flavor) + 1);
             strcpy (tile_name, flavor);
-            return fun;
+            return;
           }
           // flavor not found
           if (env[index_env] == '\0')
@@ -101,17 +124,13 @@ static void *bind_tile (char *kernel)
   }
 
   // Well, try default do_tile function
-  sprintf (buffer, "%s_do_tile_default", kernel);
-  fun = hooks_find_symbol (buffer);
-  if (fun != NULL) {
-    PRINT_DEBUG ('c', "Found [%s]\n", buffer);
+  if (bind_tile_flavor (kernel, "default")) {
     tile_name = "default";
-    return fun;
+    return;
   }
 
   // No tile function found
   tile_name = "none";
-  return NULL;
 }
 
 void hooks_establish_bindings (int silent)
@@ -134,10 +153,11 @@ void hooks_establish_bindings (int silent)
   the_refresh_img = bind_it (kernel_name, "refresh_img", variant_name, 0);
 
   if (!opencl_used) {
-    the_first_touch = bind_it (kernel_name, "ft", variant_name, do_first_touch);
+    // Without a ft hook, the generic first-touch of img_data is used
+    the_first_touch = bind_it (kernel_name, "ft", variant_name, 0);
   }
 
-  the_tile_func  = bind_tile (kernel_name);
+  bind_tile (kernel_name);
   the_tile_check = bind_it (kernel_name, "tile_check", tile_name, 0);
 
   if (!silent)
@@ -172,9 +192,45 @@ int do_tile (int x, int y, int width, int height, int who)
 
   monitoring_start_tile (who);
 
-  int r = the_tile_func (x, y, width, height);
+  int r;
+
+  if (the_inner_tile_func != NULL && x > 0 && y > 0 && x + width < DIM &&
+      y + height < DIM)
+    r = the_inner_tile_func (x, y, width, height);
+  else
+    r = the_tile_func (x, y, width, height);
 
   monitoring_end_tile (x, y, width, height, who);
 
   return r;
 }
+
+// Tiles touching the image border come first, so that the (slower) border
+// tiles are picked up early and overlap with inner tiles under dynamic
+// scheduling
+int do_tile_border_first (unsigned t, int who)
+{
+  const unsigned nx = NB_TILES_X, ny = NB_TILES_Y;
+  unsigned tx, ty;
+
+  if (nx <= 2 || ny <= 2) {
+    // All tiles touch the border
+    tx = t % nx;
+    ty = t / nx;
+  } else if (t < 2 * nx) {
+    // Top and bottom rows
+    tx = t % nx;
+    ty = (t < nx) ? 0 : ny - 1;
+  } else if (t < 2 * nx + 2 * (ny - 2)) {
+    // Left and right columns
+    t -= 2 * nx;
+    tx = (t % 2) ? nx - 1 : 0;
+    ty = 1 + t / 2;
+  } else {
+    t -= 2 * nx + 2 * (ny - 2);
+    tx = 1 + t % (nx - 2);
+    ty = 1 + t / (nx - 2);
+  }
+
+  return do_tile (tx * TILE_W, ty * TILE_H, TILE_W, TILE_H, who);
+}
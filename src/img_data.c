@@ -1,11 +1,15 @@
+#include <hwloc.h>
+#include <omp.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/mman.h>
+#include <unistd.h>
 
 #include "debug.h"
 #include "error.h"
 #include "global.h"
 #include "img_data.h"
+#include "team.h"
+#include "vec_aligned_alloc.h"
 
 uint32_t *restrict image = NULL, *restrict alt_image = NULL;
 
@@ -18,13 +22,11 @@ unsigned NB_TILES_Y = 0;
 
 void img_data_alloc (void)
 {
-  image = mmap (NULL, DIM * DIM * sizeof (uint32_t), PROT_READ | PROT_WRITE,
-                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  image = vec_huge_malloc (DIM * DIM * sizeof (uint32_t));
   if (image == NULL)
     exit_with_error ("Cannot allocate main image: mmap failed");
 
-  alt_image = mmap (NULL, DIM * DIM * sizeof (uint32_t), PROT_READ | PROT_WRITE,
-                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  alt_image = vec_huge_malloc (DIM * DIM * sizeof (uint32_t));
   if (alt_image == NULL)
     exit_with_error ("Cannot allocate alternate image: mmap failed");
 
@@ -34,12 +36,12 @@ void img_data_alloc (void)
 void img_data_free (void)
 {
   if (image != NULL) {
-    munmap (image, DIM * DIM * sizeof (uint32_t));
+    vec_huge_free (image, DIM * DIM * sizeof (uint32_t));
     image = NULL;
   }
 
   if (alt_image != NULL) {
-    munmap (alt_image, DIM * DIM * sizeof (uint32_t));
+    vec_huge_free (alt_image, DIM * DIM * sizeof (uint32_t));
     alt_image = NULL;
   }
 }
@@ -49,6 +51,140 @@ void img_data_replicate (void)
   memcpy (alt_image, image, DIM * DIM * sizeof (uint32_t));
 }
 
+///////////////////////////// Generic NUMA placement (--first-touch)
+//
+// When the kernel does not provide its own first-touch hook, pages of the
+// images and of the DIM x DIM tables registered by the kernel are touched
+// tile by tile by the thread which will compute the tile (omp for with
+// schedule(runtime), or static team distribution for *team variants).
+// Setting EASYPAP_NUMA=interleave spreads pages over all NUMA nodes instead.
+// Page placement is reported with -d n.
+
+#define MAX_FT_TABLES 8
+
+static struct
+{
+  char *name;
+  char *ptr;
+  size_t elem_size;
+} ft_tables[MAX_FT_TABLES + 2]; // + images
+
+static unsigned nb_ft_tables = 0;
+
+void img_data_register_table (char *name, void *ptr, size_t elem_size)
+{
+  if (nb_ft_tables == MAX_FT_TABLES)
+    exit_with_error ("Too many tables registered for first-touch (max %d)",
+                     MAX_FT_TABLES);
+
+  ft_tables[nb_ft_tables].name      = name;
+  ft_tables[nb_ft_tables].ptr       = ptr;
+  ft_tables[nb_ft_tables].elem_size = elem_size;
+  nb_ft_tables++;
+}
+
+static void ft_tile (int x, int y, int w, int h)
+{
+  for (unsigned t = 0; t < nb_ft_tables; t++) {
+    const size_t es = ft_tables[t].elem_size;
+
+    for (int i = y; i < y + h; i++)
+      memset (ft_tables[t].ptr + (i * DIM + x) * es, 0, w * es);
+  }
+}
+
+static void ft_team_body (unsigned me, void *arg)
+{
+  const unsigned nb_tiles = NB_TILES_X * NB_TILES_Y;
+  const unsigned first    = me * nb_tiles / team_size ();
+  const unsigned last     = (me + 1) * nb_tiles / team_size ();
+
+  for (unsigned t = first; t < last; t++)
+    ft_tile ((t % NB_TILES_X) * TILE_W, (t / NB_TILES_X) * TILE_H, TILE_W,
+             TILE_H);
+}
+
+static void ft_report (hwloc_topology_t topology)
+{
+  const long page_size   = sysconf (_SC_PAGESIZE);
+  const unsigned nb_nodes = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_NUMANODE);
+  hwloc_nodeset_t set    = hwloc_bitmap_alloc ();
+  unsigned long pages[nb_nodes + 1];
+
+  for (unsigned t = 0; t < nb_ft_tables; t++) {
+    const size_t size = DIM * DIM * ft_tables[t].elem_size;
+    char *start = (char *)((uintptr_t)ft_tables[t].ptr & ~(page_size - 1));
+
+    memset (pages, 0, sizeof (pages));
+
+    for (char *p = start; p < ft_tables[t].ptr + size; p += page_size) {
+      int node = -1;
+
+      if (!hwloc_get_area_memlocation (topology, p, page_size, set,
+                                       HWLOC_MEMBIND_BYNODESET))
+        node = hwloc_bitmap_first (set);
+
+      // Unknown location is counted last
+      pages[(node >= 0 && node < nb_nodes) ? node : nb_nodes]++;
+    }
+
+    fprintf (stderr, "NUMA placement of %s:", ft_tables[t].name);
+    for (unsigned n = 0; n < nb_nodes; n++)
+      fprintf (stderr, " node %u: %lu pages,", n, pages[n]);
+    fprintf (stderr, " unknown: %lu pages\n", pages[nb_nodes]);
+  }
+
+  hwloc_bitmap_free (set);
+}
+
+void img_data_first_touch (void)
+{
+  char *policy = getenv ("EASYPAP_NUMA");
+  hwloc_topology_t topology;
+
+  hwloc_topology_init (&topology);
+  hwloc_topology_load (topology);
+
+  // Images are first in the list
+  memmove (ft_tables + 2, ft_tables, nb_ft_tables * sizeof (ft_tables[0]));
+  ft_tables[0].name      = "image";
+  ft_tables[0].ptr       = (char *)image;
+  ft_tables[0].elem_size = sizeof (uint32_t);
+  ft_tables[1].name      = "alt_image";
+  ft_tables[1].ptr       = (char *)alt_image;
+  ft_tables[1].elem_size = sizeof (uint32_t);
+  nb_ft_tables += 2;
+
+  if (policy != NULL && !strcmp (policy, "interleave")) {
+    hwloc_const_nodeset_t all = hwloc_topology_get_topology_nodeset (topology);
+
+    for (unsigned t = 0; t < nb_ft_tables; t++)
+      if (hwloc_set_area_membind (topology, ft_tables[t].ptr,
+                                  DIM * DIM * ft_tables[t].elem_size, all,
+                                  HWLOC_MEMBIND_INTERLEAVE,
+                                  HWLOC_MEMBIND_BYNODESET))
+        PRINT_DEBUG ('n', "Cannot interleave %s\n", ft_tables[t].name);
+  } else if (policy != NULL && strcmp (policy, "tiles"))
+    exit_with_error ("Unknown EASYPAP_NUMA policy: %s (tiles|interleave)",
+                     policy);
+
+  if (strstr (variant_name, "team") != NULL)
+    team_run (ft_team_body, NULL);
+  else {
+#pragma omp parallel for schedule(runtime) collapse(2)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        ft_tile (x, y, TILE_W, TILE_H);
+  }
+
+  if (debug_enabled ('n'))
+    ft_report (topology);
+
+  hwloc_topology_destroy (topology);
+
+  nb_ft_tables = 0;
+}
+
 unsigned heat_to_rgb (float h) // 0.0 = cold, 1.0 = hot
 {
   int i;
@@ -360,6 +360,9 @@ static void init_phases (void)
     if (the_first_touch != NULL) {
       the_first_touch ();
       PRINT_DEBUG ('i', "Init phase 5: first-touch() hook called\n");
+    } else if (!opencl_used) {
+      img_data_first_touch ();
+      PRINT_DEBUG ('i', "Init phase 5: generic first-touch done\n");
     } else
       PRINT_DEBUG ('i', "Init phase 5: [no first-touch() hook defined]\n");
   } else
@@ -657,6 +660,9 @@ int main (int argc, char **argv)
   if (the_finalize != NULL)
     the_finalize ();
 
+  // Only joins the thread team if some *_team variant started it
+  team_finalize ();
+
 #ifdef ENABLE_SDL
   graphics_clean ();
 #endif
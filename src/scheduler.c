@@ -2,24 +2,45 @@
 #define _GNU_SOURCE
 #include <hwloc.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "debug.h"
+#include "error.h"
 #include "global.h"
 #include "scheduler.h"
 
+// Each worker owns a Chase-Lev work-stealing deque: the owner pushes and pops
+// tasks at the bottom, while idle workers steal them from the top. Tasks
+// created by the master thread (i.e. outside of workers) with cpu == -1 are
+// pushed on a separate deque owned by the master, from which all workers
+// steal. Tasks bound to a given cpu are posted to the mailbox of the
+// corresponding worker (a lock-free LIFO list), and are never stolen.
+//
+// Tasks created with scheduler_create_task_dep count their pending
+// predecessors. When a task completes, it releases its successors, and
+// those which become ready are pushed on the deque of the releasing worker
+// (they are likely to use the same data).
+
 static int nbWorkers = -1;
 
-volatile static int nbTask = 0;
-pthread_mutex_t mutex      = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t cond        = PTHREAD_COND_INITIALIZER;
+static atomic_int nbTask = 0;   // number of created and not yet completed tasks
+static atomic_int nbSleepers = 0;
+static atomic_int finished   = 0;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wakeup = PTHREAD_COND_INITIALIZER; // idle workers
+static pthread_cond_t done   = PTHREAD_COND_INITIALIZER; // scheduler_task_wait
 
 static hwloc_topology_t topology;
 static unsigned nb_cores;
+static unsigned topology_users = 0;
 
-#define WORK_QUEUE 1024
+#define DEQUE_INITIAL_SIZE 1024
+#define SPIN_BEFORE_SLEEP 256
 
 struct task
 {
@@ -27,60 +48,235 @@ struct task
   void *p;
 };
 
+struct task_node
+{
+  struct task task;
+  struct task_node *next;
+};
+
+struct array
+{
+  long size; // power of 2
+  struct array *prev; // older (smaller) arrays, freed at the end
+  struct task buf[];
+};
+
+struct deque
+{
+  atomic_long top, bottom;
+  _Atomic (struct array *) array;
+};
+
 struct worker
 {
   int id;
   pthread_t tid;
   pthread_attr_t attr;
-  pthread_cond_t cond;
-  pthread_mutex_t mutex;
-  int fin, todo;
-  struct task tasks[WORK_QUEUE];
-  unsigned d, f;
+  struct deque deque;
+  _Atomic (struct task_node *) mailbox;
+  unsigned seed;
 } * workers;
 
-void scheduler_task_wait ()
+static struct deque master_deque;
+
+struct succ_node
 {
-  pthread_mutex_lock (&mutex);
-  while (nbTask > 0)
-    pthread_cond_wait (&cond, &mutex);
-  pthread_mutex_unlock (&mutex);
+  struct task_handle *task;
+  struct succ_node *next;
+};
+
+struct task_handle
+{
+  struct task task;
+  unsigned cpu;
+  atomic_int pending; // number of predecessors still running, plus one
+  _Atomic (struct succ_node *) successors;
+  struct task_handle *next; // all handles are freed by scheduler_task_wait
+};
+
+// Successor list of completed tasks
+static struct succ_node closed;
+#define CLOSED (&closed)
+
+static _Atomic (struct task_handle *) handles = NULL;
+
+// Index of the worker running the current thread, -1 for the master thread
+static __thread int my_worker = -1;
+
+static struct array *array_alloc (long size, struct array *prev)
+{
+  struct array *a = malloc (sizeof (struct array) + size * sizeof (struct task));
+
+  if (a == NULL)
+    exit_with_error ("Cannot allocate scheduler deque");
+
+  a->size = size;
+  a->prev = prev;
+
+  return a;
 }
 
-static void one_more_task ()
+static void deque_init (struct deque *q)
 {
-  pthread_mutex_lock (&mutex);
-  nbTask++;
-  pthread_mutex_unlock (&mutex);
+  atomic_init (&q->top, 0);
+  atomic_init (&q->bottom, 0);
+  atomic_init (&q->array, array_alloc (DEQUE_INITIAL_SIZE, NULL));
+}
+
+static void deque_free (struct deque *q)
+{
+  struct array *a = atomic_load (&q->array);
+
+  while (a != NULL) {
+    struct array *prev = a->prev;
+    free (a);
+    a = prev;
+  }
+}
+
+// Owner only
+static void deque_push (struct deque *q, struct task t)
+{
+  long b          = atomic_load_explicit (&q->bottom, memory_order_relaxed);
+  long top        = atomic_load_explicit (&q->top, memory_order_acquire);
+  struct array *a = atomic_load_explicit (&q->array, memory_order_relaxed);
+
+  if (b - top > a->size - 1) {
+    // The deque is full: we double its size. Thieves may still be reading the
+    // old array, so it is only freed by scheduler_finalize.
+    struct array *n = array_alloc (2 * a->size, a);
+
+    for (long i = top; i < b; i++)
+      n->buf[i & (n->size - 1)] = a->buf[i & (a->size - 1)];
+
+    atomic_store_explicit (&q->array, n, memory_order_release);
+    a = n;
+  }
+
+  a->buf[b & (a->size - 1)] = t;
+  atomic_thread_fence (memory_order_release);
+  atomic_store_explicit (&q->bottom, b + 1, memory_order_relaxed);
+}
+
+// Owner only
+static int deque_pop (struct deque *q, struct task *t)
+{
+  long b          = atomic_load_explicit (&q->bottom, memory_order_relaxed) - 1;
+  struct array *a = atomic_load_explicit (&q->array, memory_order_relaxed);
+  int found       = 1;
+
+  atomic_store_explicit (&q->bottom, b, memory_order_relaxed);
+  atomic_thread_fence (memory_order_seq_cst);
+
+  long top = atomic_load_explicit (&q->top, memory_order_relaxed);
+
+  if (top <= b) {
+    *t = a->buf[b & (a->size - 1)];
+    if (top == b) {
+      // Last task: we race with thieves
+      if (!atomic_compare_exchange_strong_explicit (
+              &q->top, &top, top + 1, memory_order_seq_cst,
+              memory_order_relaxed))
+        found = 0;
+      atomic_store_explicit (&q->bottom, b + 1, memory_order_relaxed);
+    }
+  } else {
+    found = 0;
+    atomic_store_explicit (&q->bottom, b + 1, memory_order_relaxed);
+  }
+
+  return found;
+}
+
+// Any thread
+static int deque_steal (struct deque *q, struct task *t)
+{
+  long top = atomic_load_explicit (&q->top, memory_order_acquire);
+  atomic_thread_fence (memory_order_seq_cst);
+  long b = atomic_load_explicit (&q->bottom, memory_order_acquire);
+
+  if (top < b) {
+    struct array *a = atomic_load_explicit (&q->array, memory_order_acquire);
+
+    *t = a->buf[top & (a->size - 1)];
+    // If the CAS fails, the task we read was taken by someone else
+    return atomic_compare_exchange_strong_explicit (
+        &q->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+  }
+
+  return 0;
+}
+
+static int deque_empty (struct deque *q)
+{
+  return atomic_load (&q->top) >= atomic_load (&q->bottom);
+}
+
+static void wake_up_workers (void)
+{
+  atomic_thread_fence (memory_order_seq_cst);
+
+  if (atomic_load (&nbSleepers) > 0) {
+    pthread_mutex_lock (&mutex);
+    pthread_cond_broadcast (&wakeup);
+    pthread_mutex_unlock (&mutex);
+  }
+}
+
+void scheduler_task_wait ()
+{
+  if (atomic_load (&nbTask) > 0) {
+    pthread_mutex_lock (&mutex);
+    while (atomic_load (&nbTask) > 0)
+      pthread_cond_wait (&done, &mutex);
+    pthread_mutex_unlock (&mutex);
+  }
+
+  // No task can reference the handles anymore
+  struct task_handle *h = atomic_exchange (&handles, NULL);
+
+  while (h != NULL) {
+    struct task_handle *next = h->next;
+    free (h);
+    h = next;
+  }
 }
 
 static void one_less_task ()
 {
-  pthread_mutex_lock (&mutex);
-  nbTask--;
-  if (nbTask == 0)
-    pthread_cond_signal (&cond);
-  pthread_mutex_unlock (&mutex);
+  if (atomic_fetch_sub (&nbTask, 1) == 1) {
+    pthread_mutex_lock (&mutex);
+    pthread_cond_broadcast (&done);
+    pthread_mutex_unlock (&mutex);
+  }
 }
 
-static void add_task (struct task todo, int w)
+static void post_task (struct task todo, int w)
 {
-  one_more_task ();
-  pthread_mutex_lock (&workers[w].mutex);
-  workers[w].tasks[workers[w].f] = todo;
-  workers[w].f                   = (workers[w].f + 1) % WORK_QUEUE;
-  workers[w].todo++;
-  assert (workers[w].todo < WORK_QUEUE);
-  pthread_cond_signal (&workers[w].cond);
-  pthread_mutex_unlock (&workers[w].mutex);
+  struct task_node *node = malloc (sizeof (struct task_node));
+
+  node->task = todo;
+  node->next = atomic_load_explicit (&workers[w].mailbox, memory_order_relaxed);
+
+  while (!atomic_compare_exchange_weak_explicit (
+      &workers[w].mailbox, &node->next, node, memory_order_release,
+      memory_order_relaxed))
+    ;
 }
 
-static void no_more_task (int w)
+static void submit_task (struct task todo, unsigned cpu)
 {
-  pthread_mutex_lock (&workers[w].mutex);
-  workers[w].fin = 1;
-  pthread_cond_signal (&workers[w].cond);
-  pthread_mutex_unlock (&workers[w].mutex);
+  if (cpu == -1) {
+    // Dynamic placement: the task goes to the deque of the current worker (so
+    // it is likely to run on the same core), unless an idle worker steals it
+    if (my_worker != -1)
+      deque_push (&workers[my_worker].deque, todo);
+    else
+      deque_push (&master_deque, todo);
+  } else
+    post_task (todo, cpu % nbWorkers);
+
+  wake_up_workers ();
 }
 
 void scheduler_create_task (task_func_t task, void *param, unsigned cpu)
@@ -90,22 +286,155 @@ void scheduler_create_task (task_func_t task, void *param, unsigned cpu)
   todo.p   = param;
   todo.fun = task;
 
-  if (cpu == -1) {
-    static int cyclic = 0;
-    // We quickly go through the list of workers to find an idle one, or the
-    // least busy one
-    PRINT_DEBUG ('s', "Dynamic task scheduling is not yet implemented\n");
-    cpu    = cyclic;
-    cyclic = (cyclic + 1) % nbWorkers;
+  atomic_fetch_add_explicit (&nbTask, 1, memory_order_relaxed);
+
+  submit_task (todo, cpu);
+}
+
+static void run_dep_task (void *p, unsigned cpu);
+
+static void release_task (struct task_handle *h)
+{
+  if (atomic_fetch_sub (&h->pending, 1) == 1) {
+    struct task todo = {run_dep_task, h};
+
+    submit_task (todo, h->cpu);
+  }
+}
+
+static void run_dep_task (void *p, unsigned cpu)
+{
+  struct task_handle *h = (struct task_handle *)p;
+
+  h->task.fun (h->task.p, cpu);
+
+  // From now on, new successors will not wait for us
+  struct succ_node *s = atomic_exchange (&h->successors, CLOSED);
+
+  while (s != NULL) {
+    struct succ_node *next = s->next;
+    release_task (s->task);
+    free (s);
+    s = next;
+  }
+}
+
+task_handle_t scheduler_create_task_dep (task_func_t task, void *param,
+                                         unsigned cpu, task_handle_t deps[],
+                                         unsigned nb_deps)
+{
+  struct task_handle *h = malloc (sizeof (struct task_handle));
+
+  h->task.fun = task;
+  h->task.p   = param;
+  h->cpu      = cpu;
+  atomic_init (&h->pending, 1); // the task cannot start before we are done
+  atomic_init (&h->successors, NULL);
+
+  h->next = atomic_load_explicit (&handles, memory_order_relaxed);
+  while (!atomic_compare_exchange_weak (&handles, &h->next, h))
+    ;
+
+  atomic_fetch_add_explicit (&nbTask, 1, memory_order_relaxed);
+
+  for (unsigned d = 0; d < nb_deps; d++) {
+    if (deps[d] == NULL)
+      continue;
+
+    struct succ_node *node = malloc (sizeof (struct succ_node));
+
+    node->task = h;
+    node->next = atomic_load (&deps[d]->successors);
+
+    // Must be done before the predecessor can release us
+    atomic_fetch_add (&h->pending, 1);
+
+    do {
+      if (node->next == CLOSED) { // predecessor already completed
+        atomic_fetch_sub (&h->pending, 1);
+        free (node);
+        break;
+      }
+    } while (!atomic_compare_exchange_weak (&deps[d]->successors, &node->next,
+                                            node));
+  }
+
+  release_task (h);
+
+  return h;
+}
+
+static void run_task (struct worker *me, struct task *todo, unsigned *tasks)
+{
+  (*tasks)++;
+  todo->fun (todo->p, me->id);
+  one_less_task ();
+}
+
+// Runs the tasks posted to our mailbox, in creation order
+static int run_mailbox (struct worker *me, unsigned *tasks)
+{
+  struct task_node *list = atomic_exchange_explicit (&me->mailbox, NULL,
+                                                     memory_order_acquire);
+  struct task_node *rev  = NULL;
+
+  if (list == NULL)
+    return 0;
+
+  while (list != NULL) {
+    struct task_node *next = list->next;
+    list->next             = rev;
+    rev                    = list;
+    list                   = next;
+  }
+
+  while (rev != NULL) {
+    struct task_node *next = rev->next;
+    run_task (me, &rev->task, tasks);
+    free (rev);
+    rev = next;
+  }
+
+  return 1;
+}
+
+static int try_steal (struct worker *me, struct task *todo)
+{
+  if (deque_steal (&master_deque, todo))
+    return 1;
+
+  if (nbWorkers > 1) {
+    // Start from a random victim to spread the contention
+    int start = rand_r (&me->seed) % nbWorkers;
+
+    for (int i = 0; i < nbWorkers; i++) {
+      int v = (start + i) % nbWorkers;
+      if (v != me->id && deque_steal (&workers[v].deque, todo))
+        return 1;
+    }
   }
-  add_task (todo, cpu);
+
+  return 0;
+}
+
+static int work_available (struct worker *me)
+{
+  if (atomic_load (&me->mailbox) != NULL || !deque_empty (&master_deque))
+    return 1;
+
+  for (int i = 0; i < nbWorkers; i++)
+    if (!deque_empty (&workers[i].deque))
+      return 1;
+
+  return 0;
 }
 
 static void *worker_main (void *p)
 {
   struct worker *me = (struct worker *)p;
-  struct task todo  = {NULL, NULL};
+  struct task todo;
   unsigned tasks    = 0;
+  unsigned idle     = 0;
   hwloc_obj_t obj;
   hwloc_bitmap_t set;
 
@@ -114,70 +443,98 @@ static void *worker_main (void *p)
   // hwloc_bitmap_singlify (set);
   hwloc_set_cpubind (topology, set, HWLOC_CPUBIND_THREAD);
 
+  my_worker = me->id;
+
   PRINT_DEBUG ('s', "Hey, I'm worker %d\n", me->id);
 
   while (1) {
 
-    pthread_mutex_lock (&me->mutex);
-
-    if (me->d == me->f && me->fin == 0)
-      pthread_cond_wait (&me->cond, &me->mutex);
+    if (run_mailbox (me, &tasks)) {
+      idle = 0;
+      continue;
+    }
 
-    if (me->d != me->f) {
-      todo  = me->tasks[me->d];
-      me->d = (me->d + 1) % WORK_QUEUE;
-      me->todo--;
-    } else if (me->fin == 1) {
-      me->fin = -1;
+    if (deque_pop (&me->deque, &todo) || try_steal (me, &todo)) {
+      run_task (me, &todo, &tasks);
+      idle = 0;
+      continue;
     }
 
-    pthread_mutex_unlock (&me->mutex);
+    if (atomic_load (&finished))
+      break;
 
-    if (me->fin == -1) {
-      PRINT_DEBUG ('s', "Worker %d has computed %d tasks\n", me->id, tasks);
-      return NULL;
+    if (++idle < SPIN_BEFORE_SLEEP) {
+      sched_yield ();
+      continue;
     }
 
-    tasks++;
-    todo.fun (todo.p, me->id);
-    one_less_task ();
+    // Go to sleep, unless some work arrived in the meantime
+    pthread_mutex_lock (&mutex);
+    atomic_fetch_add (&nbSleepers, 1);
+    if (!work_available (me) && !atomic_load (&finished))
+      pthread_cond_wait (&wakeup, &mutex);
+    atomic_fetch_sub (&nbSleepers, 1);
+    pthread_mutex_unlock (&mutex);
+    idle = 0;
   }
+
+  PRINT_DEBUG ('s', "Worker %d has computed %d tasks\n", me->id, tasks);
+
+  return NULL;
 }
 
-unsigned scheduler_init (unsigned default_P)
+hwloc_topology_t scheduler_get_topology (void)
 {
-  int i;
+  if (topology_users++ == 0) {
+    /* Allocate and initialize topology object. */
+    hwloc_topology_init (&topology);
 
-  /* Allocate and initialize topology object. */
-  hwloc_topology_init (&topology);
+    /* Perform the topology detection. */
+    hwloc_topology_load (topology);
 
-  /* Perform the topology detection. */
-  hwloc_topology_load (topology);
+    nb_cores = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_PU);
+  }
 
-  nb_cores = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_PU);
+  return topology;
+}
+
+void scheduler_release_topology (void)
+{
+  if (--topology_users == 0)
+    /* Destroy topology object. */
+    hwloc_topology_destroy (topology);
+}
+
+unsigned scheduler_init (unsigned default_P)
+{
+  int i;
+
+  scheduler_get_topology ();
 
   if (default_P != -1)
     nbWorkers = default_P;
   else
     nbWorkers =  easypap_requested_number_of_threads ();
-  
+
   PRINT_DEBUG ('s', "[Starting %d workers]\n", nbWorkers);
 
+  atomic_store (&finished, 0);
+  deque_init (&master_deque);
+
   workers = malloc (nbWorkers * sizeof (struct worker));
 
+  // All deques must be ready before the first worker tries to steal
   for (i = 0; i < nbWorkers; i++) {
     workers[i].id   = i;
-    workers[i].fin  = 0;
-    workers[i].todo = 0;
-    workers[i].d    = 0;
-    workers[i].f    = 0;
-    pthread_cond_init (&workers[i].cond, NULL);
-    pthread_mutex_init (&workers[i].mutex, NULL);
+    workers[i].seed = i + 1;
+    deque_init (&workers[i].deque);
+    atomic_init (&workers[i].mailbox, NULL);
     pthread_attr_init (&workers[i].attr);
+  }
 
+  for (i = 0; i < nbWorkers; i++)
     pthread_create (&workers[i].tid, &workers[i].attr, worker_main,
                     &workers[i]);
-  }
 
   return nbWorkers;
 }
@@ -186,16 +543,23 @@ void scheduler_finalize (void)
 {
   int i;
 
-  for (i = 0; i < nbWorkers; i++)
-    no_more_task (i);
+  scheduler_task_wait ();
+
+  atomic_store (&finished, 1);
+  pthread_mutex_lock (&mutex);
+  pthread_cond_broadcast (&wakeup);
+  pthread_mutex_unlock (&mutex);
 
   for (i = 0; i < nbWorkers; i++)
     pthread_join (workers[i].tid, NULL);
 
+  for (i = 0; i < nbWorkers; i++)
+    deque_free (&workers[i].deque);
+  deque_free (&master_deque);
+
   free (workers);
 
-  /* Destroy topology object. */
-  hwloc_topology_destroy (topology);
+  scheduler_release_topology ();
 
   PRINT_DEBUG ('s', "[Workers stopped]\n");
 }
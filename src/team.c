@@ -0,0 +1,249 @@
+
+#define _GNU_SOURCE
+#include <hwloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api_funcs.h"
+#include "debug.h"
+#include "error.h"
+#include "global.h"
+#include "hooks.h"
+#include "scheduler.h"
+#include "team.h"
+
+// Number of unsuccessful polls before yielding the cpu (barrier) or going to
+// sleep (idle helpers)
+#define SPIN_BEFORE_YIELD 1024
+#define SPIN_BEFORE_SLEEP (64 * SPIN_BEFORE_YIELD)
+
+#define CACHE_LINE 64
+
+struct member
+{
+  pthread_t tid;
+  unsigned id;
+  int sense;        // barrier sense of this member
+  unsigned calls;   // number of team_for_tiles calls, for double buffering
+  int change[2];    // do_tile results of the two last team_for_tiles calls
+} __attribute__ ((aligned (CACHE_LINE)));
+
+static unsigned nb_members = 0;
+static struct member *members = NULL;
+
+static hwloc_topology_t topology;
+static unsigned nb_cores;
+
+static int dynamic_schedule = 0;
+
+// Barrier
+static atomic_uint barrier_count __attribute__ ((aligned (CACHE_LINE))) = 0;
+static atomic_int barrier_sense __attribute__ ((aligned (CACHE_LINE)))  = 0;
+
+// Current job
+static team_func_t job_func = NULL;
+static void *job_arg        = NULL;
+static atomic_uint job_epoch __attribute__ ((aligned (CACHE_LINE))) = 0;
+static atomic_int quit = 0;
+
+static atomic_uint next_tile[2] __attribute__ ((aligned (CACHE_LINE)));
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wakeup = PTHREAD_COND_INITIALIZER;
+static atomic_int nb_sleepers = 0;
+
+static inline void cpu_relax (unsigned *spin)
+{
+  if (++*spin % SPIN_BEFORE_YIELD == 0)
+    sched_yield ();
+#if defined(__x86_64__) || defined(__i386__)
+  else
+    __builtin_ia32_pause ();
+#endif
+}
+
+void team_barrier (unsigned me)
+{
+  const int sense = members[me].sense = !members[me].sense;
+
+  if (atomic_fetch_add (&barrier_count, 1) == nb_members - 1) {
+    // Last one: reset the counter, then release the others
+    atomic_store_explicit (&barrier_count, 0, memory_order_relaxed);
+    atomic_store_explicit (&barrier_sense, sense, memory_order_release);
+  } else {
+    unsigned spin = 0;
+
+    while (atomic_load_explicit (&barrier_sense, memory_order_acquire) !=
+           sense)
+      cpu_relax (&spin);
+  }
+}
+
+int team_for_tiles (unsigned me)
+{
+  const unsigned nb_tiles = NB_TILES_X * NB_TILES_Y;
+  const unsigned p        = members[me].calls++ & 1;
+  int change              = 0;
+
+  if (dynamic_schedule) {
+    unsigned t;
+
+    while ((t = atomic_fetch_add_explicit (&next_tile[p], 1,
+                                           memory_order_relaxed)) < nb_tiles)
+      change |= do_tile ((t % NB_TILES_X) * TILE_W, (t / NB_TILES_X) * TILE_H,
+                         TILE_W, TILE_H, me);
+  } else {
+    const unsigned first = me * nb_tiles / nb_members;
+    const unsigned last  = (me + 1) * nb_tiles / nb_members;
+
+    for (unsigned t = first; t < last; t++)
+      change |= do_tile ((t % NB_TILES_X) * TILE_W, (t / NB_TILES_X) * TILE_H,
+                         TILE_W, TILE_H, me);
+  }
+
+  members[me].change[p] = change;
+
+  team_barrier (me);
+
+  // Nobody will use this counter before the next barrier
+  if (me == 0)
+    atomic_store_explicit (&next_tile[p], 0, memory_order_relaxed);
+
+  for (unsigned i = 0; i < nb_members; i++)
+    change |= members[i].change[p];
+
+  return change;
+}
+
+static void *member_main (void *p)
+{
+  struct member *me = (struct member *)p;
+  unsigned epoch    = 0;
+  hwloc_obj_t obj;
+
+  obj = hwloc_get_obj_by_type (topology, HWLOC_OBJ_PU, me->id % nb_cores);
+  hwloc_set_cpubind (topology, obj->cpuset, HWLOC_CPUBIND_THREAD);
+
+  PRINT_DEBUG ('t', "Team member %d started\n", me->id);
+
+  for (;;) {
+    unsigned spin = 0;
+
+    // Wait for the next job
+    while (atomic_load_explicit (&job_epoch, memory_order_acquire) == epoch &&
+           !atomic_load (&quit)) {
+      if (spin < SPIN_BEFORE_SLEEP)
+        cpu_relax (&spin);
+      else {
+        pthread_mutex_lock (&mutex);
+        atomic_fetch_add (&nb_sleepers, 1);
+        if (atomic_load (&job_epoch) == epoch && !atomic_load (&quit))
+          pthread_cond_wait (&wakeup, &mutex);
+        atomic_fetch_sub (&nb_sleepers, 1);
+        pthread_mutex_unlock (&mutex);
+      }
+    }
+
+    if (atomic_load (&quit))
+      break;
+
+    epoch++;
+
+    job_func (me->id, job_arg);
+
+    team_barrier (me->id);
+  }
+
+  return NULL;
+}
+
+void team_run (team_func_t f, void *arg)
+{
+  // The team is only started when some variant needs it
+  if (members == NULL)
+    team_init (easypap_requested_number_of_threads ());
+
+  job_func = f;
+  job_arg  = arg;
+
+  atomic_fetch_add (&job_epoch, 1);
+
+  if (atomic_load (&nb_sleepers) > 0) {
+    pthread_mutex_lock (&mutex);
+    pthread_cond_broadcast (&wakeup);
+    pthread_mutex_unlock (&mutex);
+  }
+
+  f (0, arg);
+
+  team_barrier (0);
+}
+
+unsigned team_size (void)
+{
+  return nb_members;
+}
+
+unsigned team_init (unsigned nb_threads)
+{
+  char *sched = getenv ("OMP_SCHEDULE");
+
+  if (members != NULL) // already started
+    return nb_members;
+
+  if (nb_threads == 0)
+    exit_with_error ("Thread team must contain at least one thread");
+
+  topology = scheduler_get_topology ();
+  nb_cores = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_PU);
+
+  dynamic_schedule = sched != NULL && (!strncmp (sched, "dynamic", 7) ||
+                                       !strncmp (sched, "guided", 6));
+
+  nb_members = nb_threads;
+  if (posix_memalign ((void **)&members, CACHE_LINE,
+                      nb_members * sizeof (struct member)))
+    exit_with_error ("Cannot allocate thread team");
+
+  atomic_store (&next_tile[0], 0);
+  atomic_store (&next_tile[1], 0);
+
+  for (unsigned i = 0; i < nb_members; i++) {
+    members[i].id        = i;
+    members[i].sense     = 0;
+    members[i].calls     = 0;
+    members[i].change[0] = members[i].change[1] = 0;
+  }
+
+  for (unsigned i = 1; i < nb_members; i++)
+    pthread_create (&members[i].tid, NULL, member_main, &members[i]);
+
+  PRINT_DEBUG ('t', "Thread team of %d threads started (%s schedule)\n",
+               nb_members, dynamic_schedule ? "dynamic" : "static");
+
+  return nb_members;
+}
+
+void team_finalize (void)
+{
+  if (members == NULL)
+    return;
+
+  atomic_store (&quit, 1);
+
+  pthread_mutex_lock (&mutex);
+  pthread_cond_broadcast (&wakeup);
+  pthread_mutex_unlock (&mutex);
+
+  for (unsigned i = 1; i < nb_members; i++)
+    pthread_join (members[i].tid, NULL);
+
+  free (members);
+  members = NULL;
+
+  scheduler_release_topology ();
+}
@@ -1,7 +1,11 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
+#include "debug.h"
 #include "vec_aligned_alloc.h"
 
 // VEC_ALIGNMENT (in bytes) must be a power of two
@@ -45,3 +49,94 @@ void vec_aligned_free (void *p)
     free (real);
   }
 }
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+static inline size_t huge_round (size_t size)
+{
+  return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+// Returns 0 if transparent huge pages are disabled system-wide
+static int thp_enabled (void)
+{
+  static int enabled = -1;
+
+  if (enabled == -1) {
+    char buffer[128] = "";
+    FILE *f = fopen ("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+
+    if (f != NULL) {
+      if (fgets (buffer, sizeof (buffer), f) == NULL)
+        buffer[0] = '\0';
+      fclose (f);
+    }
+    enabled = (strstr (buffer, "[never]") == NULL) && (f != NULL);
+  }
+
+  return enabled;
+}
+
+void *vec_huge_malloc (size_t size)
+{
+  void *p;
+
+  if (size < HUGE_PAGE_SIZE) {
+    p = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+              -1, 0);
+    if (p == MAP_FAILED)
+      return NULL;
+
+    PRINT_DEBUG ('a', "%zu bytes allocated using %ld KB pages\n", size,
+                 sysconf (_SC_PAGESIZE) / 1024);
+    return p;
+  }
+
+  size = huge_round (size);
+
+#ifdef MAP_HUGETLB
+  // Only succeeds if huge pages were reserved (/proc/sys/vm/nr_hugepages)
+  p = mmap (NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (p != MAP_FAILED) {
+    PRINT_DEBUG ('a', "%zu bytes allocated using 2 MB pages (hugetlbfs)\n",
+                 size);
+    return p;
+  }
+#endif
+
+  // Transparent huge pages require 2 MB-aligned areas, so we allocate one
+  // more huge page and unmap the unaligned head and tail
+  char *area = mmap (NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (area == MAP_FAILED)
+    return NULL;
+
+  char *aligned = (char *)(((uintptr_t)area + HUGE_PAGE_SIZE - 1) &
+                           ~(HUGE_PAGE_SIZE - 1));
+
+  if (aligned > area)
+    munmap (area, aligned - area);
+  munmap (aligned + size, area + HUGE_PAGE_SIZE - aligned);
+
+#ifdef MADV_HUGEPAGE
+  if (thp_enabled () && !madvise (aligned, size, MADV_HUGEPAGE)) {
+    PRINT_DEBUG ('a', "%zu bytes allocated, transparent 2 MB pages requested\n",
+                 size);
+    return aligned;
+  }
+#endif
+
+  PRINT_DEBUG ('a', "%zu bytes allocated using %ld KB pages (no huge pages)\n",
+               size, sysconf (_SC_PAGESIZE) / 1024);
+
+  return aligned;
+}
+
+void vec_huge_free (void *p, size_t size)
+{
+  if (p == NULL)
+    return;
+
+  munmap (p, size < HUGE_PAGE_SIZE ? size : huge_round (size));
+}
@@ -18,6 +18,7 @@ typedef struct
 {
   long start_time, end_time;
   long correction, gap;
+  long counter; // sum of the values recorded by the kernel, -1 if none
   struct list_head chain;
   trace_task_t **first_cpu_task;
 } trace_iteration_t;
@@ -60,6 +61,7 @@ void trace_data_add_task (trace_t *tr, long start_time, long end_time,
 
 void trace_data_start_iteration (trace_t *tr, long start_time);
 void trace_data_end_iteration (trace_t *tr, long end_time);
+void trace_data_add_counter (trace_t *tr, unsigned value);
 
 void trace_data_no_more_data (trace_t *tr);
 
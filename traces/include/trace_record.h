@@ -18,6 +18,7 @@ void __trace_record_start_tile (long time, unsigned cpu);
 void __trace_record_end_tile (long time, unsigned cpu, unsigned x, unsigned y,
                               unsigned w, unsigned h, int task_type,
                               int task_id);
+void __trace_record_counter (unsigned value);
 void trace_record_finalize (void);
 
 #define trace_record_start_iteration(t)                                        \
@@ -44,6 +45,12 @@ void trace_record_finalize (void);
       __trace_record_end_tile ((t), (c), (x), (y), (w), (h), (tt), (tid));     \
   } while (0)
 
+#define trace_record_counter(v)                                                \
+  do {                                                                         \
+    if (do_trace)                                                              \
+      __trace_record_counter (v);                                              \
+  } while (0)
+
 #else
 
 #define do_trace (unsigned)0
@@ -54,6 +61,7 @@ void trace_record_finalize (void);
 #define trace_record_end_iteration(t) (void)0
 #define trace_record_start_tile(t, c) (void)0
 #define trace_record_end_tile(t, c, x, y, w, h, tt, tid) (void)0
+#define trace_record_counter(v) (void)0
 
 #endif
 
@@ -153,6 +153,7 @@ void trace_data_start_iteration (trace_t *tr, long start_time)
   current_it                 = malloc (sizeof (trace_iteration_t));
   current_it->correction     = 0;
   current_it->gap            = 0;
+  current_it->counter        = -1;
   current_it->start_time     = shift (start_time);
   current_it->first_cpu_task = malloc (tr->nb_cores * sizeof (trace_task_t *));
   for (int c = 0; c < tr->nb_cores; c++)
@@ -178,6 +179,13 @@ void trace_data_end_iteration (trace_t *tr, long end_time)
   // end_last_iteration);
 }
 
+void trace_data_add_counter (trace_t *tr, unsigned value)
+{
+  if (current_it->counter < 0)
+    current_it->counter = 0;
+  current_it->counter += value;
+}
+
 void trace_data_no_more_data (trace_t *tr)
 {
   unsigned cpt  = 0;
@@ -75,6 +75,10 @@ void trace_file_load (char *file)
           TASK_EXTRACT_TTYPE (ev.param[6]), TASK_EXTRACT_TID (ev.param[6]));
       break;
 
+    case TRACE_COUNTER:
+      trace_data_add_counter (&trace[nb_traces], ev.param[0]);
+      break;
+
     case TRACE_DIM:
       trace_data_set_dim (&trace[nb_traces], ev.param[0]);
       break;
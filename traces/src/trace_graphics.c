@@ -1038,6 +1038,39 @@ static void display_mouse_selection (const selected_task_info_t *selected)
   }
 }
 
+// Kernels may record a value per iteration with monitoring_counter (e.g.
+// number of active tiles or of swept cells): it is displayed at the bottom of
+// the hovered iteration
+static void display_iteration_counters (void)
+{
+  if (horiz_mode || !mouse_in_gantt_zone)
+    return;
+
+  const long time = pixel_to_time (mouse.x);
+
+  for (int t = 0; t < nb_traces; t++) {
+    if (trace[t].nb_iterations == 0)
+      continue;
+
+    int it = trace_data_search_iteration (trace + t, time);
+
+    if (it == -1 || trace[t].iteration[it].counter < 0)
+      continue;
+
+    SDL_Rect r;
+
+    r.x = time_to_pixel (iteration_start_time (trace + t, it));
+    r.w = time_to_pixel (iteration_end_time (trace + t, it)) - r.x + 1;
+    r.h = digit_tex_height;
+    r.y = trace_display_info[t].gantt.y + trace_display_info[t].gantt.h - r.h;
+
+    SDL_SetRenderDrawColor (renderer, 0, 0, 0, 255);
+    SDL_RenderFillRect (renderer, &r);
+
+    display_iter_number (trace[t].iteration[it].counter, r.y, r.x, r.w);
+  }
+}
+
 static void display_misc_status (void)
 {
   SDL_RenderCopy (renderer, quick_nav_tex, NULL, &quick_nav_rect);
@@ -1450,6 +1483,7 @@ static void trace_graphics_display (void)
 
   // Mouse
   display_mouse_selection (&selected);
+  display_iteration_counters ();
 
   SDL_RenderPresent (renderer);
 }
@@ -106,3 +106,8 @@ void __trace_record_end_tile (long time, unsigned cpu, unsigned x, unsigned y,
   FUT_PROBE7 (0x1, TRACE_END_TILE, time, cpu, x, y, w, h,
               TASK_COMBINE (task_type, task_id));
 }
+
+void __trace_record_counter (unsigned value)
+{
+  FUT_PROBE1 (0x1, TRACE_COUNTER, value);
+}